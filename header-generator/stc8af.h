@@ -622,6 +622,14 @@ SFR(CMPCR2, 0xE7);
 
 // SFR P6: Port 6
 SFR(P6, 0xE8);
+SBIT(P6_0, 0xE8, 0);
+SBIT(P6_1, 0xE8, 1);
+SBIT(P6_2, 0xE8, 2);
+SBIT(P6_3, 0xE8, 3);
+SBIT(P6_4, 0xE8, 4);
+SBIT(P6_5, 0xE8, 5);
+SBIT(P6_6, 0xE8, 6);
+SBIT(P6_7, 0xE8, 7);
 
 // SFR CL: PCA base timer low
 SFR(CL, 0xE9);
@@ -723,6 +731,14 @@ SFR(PWMFDCR, 0xF7);
 
 // SFR P7: Port 7
 SFR(P7, 0xF8);
+SBIT(P7_0, 0xF8, 0);
+SBIT(P7_1, 0xF8, 1);
+SBIT(P7_2, 0xF8, 2);
+SBIT(P7_3, 0xF8, 3);
+SBIT(P7_4, 0xF8, 4);
+SBIT(P7_5, 0xF8, 5);
+SBIT(P7_6, 0xF8, 6);
+SBIT(P7_7, 0xF8, 7);
 
 // SFR CH: PCA base timer high
 SFR(CH, 0xF9);
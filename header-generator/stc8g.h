@@ -854,6 +854,18 @@ SFRX(P0IE, 0xFE30);
 // SFR P1IE: Port 1 input enable control register
 SFRX(P1IE, 0xFE31);
 
+// SFR P2IE: Port 2 input enable control register
+SFRX(P2IE, 0xFE32);
+
+// SFR P3IE: Port 3 input enable control register
+SFRX(P3IE, 0xFE33);
+
+// SFR P4IE: Port 4 input enable control register
+SFRX(P4IE, 0xFE34);
+
+// SFR P5IE: Port 5 input enable control register
+SFRX(P5IE, 0xFE35);
+
 // SFR I2CCFG: I2C configuration register
 SFRX(I2CCFG, 0xFE80);
 #define MSSPEED0 0x1
@@ -582,6 +582,14 @@ SFR(CMPCR2, 0xE7);
 
 // SFR P6: Port 6
 SFR(P6, 0xE8);
+SBIT(P6_0, 0xE8, 0);
+SBIT(P6_1, 0xE8, 1);
+SBIT(P6_2, 0xE8, 2);
+SBIT(P6_3, 0xE8, 3);
+SBIT(P6_4, 0xE8, 4);
+SBIT(P6_5, 0xE8, 5);
+SBIT(P6_6, 0xE8, 6);
+SBIT(P6_7, 0xE8, 7);
 
 // SFR USBDAT: USB data register
 SFR(USBDAT, 0xEC);
@@ -617,6 +625,14 @@ SFR(IAP_TPS, 0xF5);
 
 // SFR P7: Port 7
 SFR(P7, 0xF8);
+SBIT(P7_0, 0xF8, 0);
+SBIT(P7_1, 0xF8, 1);
+SBIT(P7_2, 0xF8, 2);
+SBIT(P7_3, 0xF8, 3);
+SBIT(P7_4, 0xF8, 4);
+SBIT(P7_5, 0xF8, 5);
+SBIT(P7_6, 0xF8, 6);
+SBIT(P7_7, 0xF8, 7);
 
 // SFR USBADR: USB address register
 SFR(USBADR, 0xFC);
@@ -636,6 +652,250 @@ SFR(RSTCFG, 0xFF);
 #define P54RST 0x10
 #define ENLVR 0x40
 
+// SFR DMA_UR1T_CFG: DMA UART1 transmit configuration register
+SFRX(DMA_UR1T_CFG, 0xFA30);
+#define UR1TPTY0 0x1
+#define UR1TPTY1 0x2
+#define UR1TIP0 0x4
+#define UR1TIP1 0x8
+#define UR1TIE 0x80
+
+// SFR DMA_UR1T_CR: DMA UART1 transmit control register
+SFRX(DMA_UR1T_CR, 0xFA31);
+#define UR1T_TRIG 0x40
+#define ENUR1T 0x80
+
+// SFR DMA_UR1T_STA: DMA UART1 transmit status register
+SFRX(DMA_UR1T_STA, 0xFA32);
+#define UR1TIF 0x1
+#define UR1T_TXOVW 0x4
+
+// SFR DMA_UR1T_AMT: DMA UART1 transmit amount register (bytes - 1)
+SFRX(DMA_UR1T_AMT, 0xFA33);
+
+// SFR DMA_UR1T_DONE: DMA UART1 transmitted bytes register
+SFRX(DMA_UR1T_DONE, 0xFA34);
+
+// SFR DMA_UR1T_TXAH: DMA UART1 transmit address high byte
+SFRX(DMA_UR1T_TXAH, 0xFA35);
+
+// SFR DMA_UR1T_TXAL: DMA UART1 transmit address low byte
+SFRX(DMA_UR1T_TXAL, 0xFA36);
+
+// SFR DMA_UR1R_CFG: DMA UART1 receive configuration register
+SFRX(DMA_UR1R_CFG, 0xFA38);
+#define UR1RPTY0 0x1
+#define UR1RPTY1 0x2
+#define UR1RIP0 0x4
+#define UR1RIP1 0x8
+#define UR1RIE 0x80
+
+// SFR DMA_UR1R_CR: DMA UART1 receive control register
+SFRX(DMA_UR1R_CR, 0xFA39);
+#define UR1R_CLRFIFO 0x1
+#define UR1R_TRIG 0x20
+#define ENUR1R 0x80
+
+// SFR DMA_UR1R_STA: DMA UART1 receive status register
+SFRX(DMA_UR1R_STA, 0xFA3A);
+#define UR1RIF 0x1
+#define UR1R_RXLOSS 0x2
+
+// SFR DMA_UR1R_AMT: DMA UART1 receive amount register (bytes - 1)
+SFRX(DMA_UR1R_AMT, 0xFA3B);
+
+// SFR DMA_UR1R_DONE: DMA UART1 received bytes register
+SFRX(DMA_UR1R_DONE, 0xFA3C);
+
+// SFR DMA_UR1R_RXAH: DMA UART1 receive address high byte
+SFRX(DMA_UR1R_RXAH, 0xFA3D);
+
+// SFR DMA_UR1R_RXAL: DMA UART1 receive address low byte
+SFRX(DMA_UR1R_RXAL, 0xFA3E);
+
+// SFR DMA_UR2T_CFG: DMA UART2 transmit configuration register
+SFRX(DMA_UR2T_CFG, 0xFA40);
+#define UR2TPTY0 0x1
+#define UR2TPTY1 0x2
+#define UR2TIP0 0x4
+#define UR2TIP1 0x8
+#define UR2TIE 0x80
+
+// SFR DMA_UR2T_CR: DMA UART2 transmit control register
+SFRX(DMA_UR2T_CR, 0xFA41);
+#define UR2T_TRIG 0x40
+#define ENUR2T 0x80
+
+// SFR DMA_UR2T_STA: DMA UART2 transmit status register
+SFRX(DMA_UR2T_STA, 0xFA42);
+#define UR2TIF 0x1
+#define UR2T_TXOVW 0x4
+
+// SFR DMA_UR2T_AMT: DMA UART2 transmit amount register (bytes - 1)
+SFRX(DMA_UR2T_AMT, 0xFA43);
+
+// SFR DMA_UR2T_DONE: DMA UART2 transmitted bytes register
+SFRX(DMA_UR2T_DONE, 0xFA44);
+
+// SFR DMA_UR2T_TXAH: DMA UART2 transmit address high byte
+SFRX(DMA_UR2T_TXAH, 0xFA45);
+
+// SFR DMA_UR2T_TXAL: DMA UART2 transmit address low byte
+SFRX(DMA_UR2T_TXAL, 0xFA46);
+
+// SFR DMA_UR2R_CFG: DMA UART2 receive configuration register
+SFRX(DMA_UR2R_CFG, 0xFA48);
+#define UR2RPTY0 0x1
+#define UR2RPTY1 0x2
+#define UR2RIP0 0x4
+#define UR2RIP1 0x8
+#define UR2RIE 0x80
+
+// SFR DMA_UR2R_CR: DMA UART2 receive control register
+SFRX(DMA_UR2R_CR, 0xFA49);
+#define UR2R_CLRFIFO 0x1
+#define UR2R_TRIG 0x20
+#define ENUR2R 0x80
+
+// SFR DMA_UR2R_STA: DMA UART2 receive status register
+SFRX(DMA_UR2R_STA, 0xFA4A);
+#define UR2RIF 0x1
+#define UR2R_RXLOSS 0x2
+
+// SFR DMA_UR2R_AMT: DMA UART2 receive amount register (bytes - 1)
+SFRX(DMA_UR2R_AMT, 0xFA4B);
+
+// SFR DMA_UR2R_DONE: DMA UART2 received bytes register
+SFRX(DMA_UR2R_DONE, 0xFA4C);
+
+// SFR DMA_UR2R_RXAH: DMA UART2 receive address high byte
+SFRX(DMA_UR2R_RXAH, 0xFA4D);
+
+// SFR DMA_UR2R_RXAL: DMA UART2 receive address low byte
+SFRX(DMA_UR2R_RXAL, 0xFA4E);
+
+// SFR DMA_UR3T_CFG: DMA UART3 transmit configuration register
+SFRX(DMA_UR3T_CFG, 0xFA50);
+#define UR3TPTY0 0x1
+#define UR3TPTY1 0x2
+#define UR3TIP0 0x4
+#define UR3TIP1 0x8
+#define UR3TIE 0x80
+
+// SFR DMA_UR3T_CR: DMA UART3 transmit control register
+SFRX(DMA_UR3T_CR, 0xFA51);
+#define UR3T_TRIG 0x40
+#define ENUR3T 0x80
+
+// SFR DMA_UR3T_STA: DMA UART3 transmit status register
+SFRX(DMA_UR3T_STA, 0xFA52);
+#define UR3TIF 0x1
+#define UR3T_TXOVW 0x4
+
+// SFR DMA_UR3T_AMT: DMA UART3 transmit amount register (bytes - 1)
+SFRX(DMA_UR3T_AMT, 0xFA53);
+
+// SFR DMA_UR3T_DONE: DMA UART3 transmitted bytes register
+SFRX(DMA_UR3T_DONE, 0xFA54);
+
+// SFR DMA_UR3T_TXAH: DMA UART3 transmit address high byte
+SFRX(DMA_UR3T_TXAH, 0xFA55);
+
+// SFR DMA_UR3T_TXAL: DMA UART3 transmit address low byte
+SFRX(DMA_UR3T_TXAL, 0xFA56);
+
+// SFR DMA_UR3R_CFG: DMA UART3 receive configuration register
+SFRX(DMA_UR3R_CFG, 0xFA58);
+#define UR3RPTY0 0x1
+#define UR3RPTY1 0x2
+#define UR3RIP0 0x4
+#define UR3RIP1 0x8
+#define UR3RIE 0x80
+
+// SFR DMA_UR3R_CR: DMA UART3 receive control register
+SFRX(DMA_UR3R_CR, 0xFA59);
+#define UR3R_CLRFIFO 0x1
+#define UR3R_TRIG 0x20
+#define ENUR3R 0x80
+
+// SFR DMA_UR3R_STA: DMA UART3 receive status register
+SFRX(DMA_UR3R_STA, 0xFA5A);
+#define UR3RIF 0x1
+#define UR3R_RXLOSS 0x2
+
+// SFR DMA_UR3R_AMT: DMA UART3 receive amount register (bytes - 1)
+SFRX(DMA_UR3R_AMT, 0xFA5B);
+
+// SFR DMA_UR3R_DONE: DMA UART3 received bytes register
+SFRX(DMA_UR3R_DONE, 0xFA5C);
+
+// SFR DMA_UR3R_RXAH: DMA UART3 receive address high byte
+SFRX(DMA_UR3R_RXAH, 0xFA5D);
+
+// SFR DMA_UR3R_RXAL: DMA UART3 receive address low byte
+SFRX(DMA_UR3R_RXAL, 0xFA5E);
+
+// SFR DMA_UR4T_CFG: DMA UART4 transmit configuration register
+SFRX(DMA_UR4T_CFG, 0xFA60);
+#define UR4TPTY0 0x1
+#define UR4TPTY1 0x2
+#define UR4TIP0 0x4
+#define UR4TIP1 0x8
+#define UR4TIE 0x80
+
+// SFR DMA_UR4T_CR: DMA UART4 transmit control register
+SFRX(DMA_UR4T_CR, 0xFA61);
+#define UR4T_TRIG 0x40
+#define ENUR4T 0x80
+
+// SFR DMA_UR4T_STA: DMA UART4 transmit status register
+SFRX(DMA_UR4T_STA, 0xFA62);
+#define UR4TIF 0x1
+#define UR4T_TXOVW 0x4
+
+// SFR DMA_UR4T_AMT: DMA UART4 transmit amount register (bytes - 1)
+SFRX(DMA_UR4T_AMT, 0xFA63);
+
+// SFR DMA_UR4T_DONE: DMA UART4 transmitted bytes register
+SFRX(DMA_UR4T_DONE, 0xFA64);
+
+// SFR DMA_UR4T_TXAH: DMA UART4 transmit address high byte
+SFRX(DMA_UR4T_TXAH, 0xFA65);
+
+// SFR DMA_UR4T_TXAL: DMA UART4 transmit address low byte
+SFRX(DMA_UR4T_TXAL, 0xFA66);
+
+// SFR DMA_UR4R_CFG: DMA UART4 receive configuration register
+SFRX(DMA_UR4R_CFG, 0xFA68);
+#define UR4RPTY0 0x1
+#define UR4RPTY1 0x2
+#define UR4RIP0 0x4
+#define UR4RIP1 0x8
+#define UR4RIE 0x80
+
+// SFR DMA_UR4R_CR: DMA UART4 receive control register
+SFRX(DMA_UR4R_CR, 0xFA69);
+#define UR4R_CLRFIFO 0x1
+#define UR4R_TRIG 0x20
+#define ENUR4R 0x80
+
+// SFR DMA_UR4R_STA: DMA UART4 receive status register
+SFRX(DMA_UR4R_STA, 0xFA6A);
+#define UR4RIF 0x1
+#define UR4R_RXLOSS 0x2
+
+// SFR DMA_UR4R_AMT: DMA UART4 receive amount register (bytes - 1)
+SFRX(DMA_UR4R_AMT, 0xFA6B);
+
+// SFR DMA_UR4R_DONE: DMA UART4 received bytes register
+SFRX(DMA_UR4R_DONE, 0xFA6C);
+
+// SFR DMA_UR4R_RXAH: DMA UART4 receive address high byte
+SFRX(DMA_UR4R_RXAH, 0xFA6D);
+
+// SFR DMA_UR4R_RXAL: DMA UART4 receive address low byte
+SFRX(DMA_UR4R_RXAL, 0xFA6E);
+
 // SFR MD3: MDU data register
 SFRX(MD3, 0xFCF0);
 
@@ -946,6 +1206,24 @@ SFRX(P0IE, 0xFE30);
 // SFR P1IE: Port 1 input enable control register
 SFRX(P1IE, 0xFE31);
 
+// SFR P2IE: Port 2 input enable control register
+SFRX(P2IE, 0xFE32);
+
+// SFR P3IE: Port 3 input enable control register
+SFRX(P3IE, 0xFE33);
+
+// SFR P4IE: Port 4 input enable control register
+SFRX(P4IE, 0xFE34);
+
+// SFR P5IE: Port 5 input enable control register
+SFRX(P5IE, 0xFE35);
+
+// SFR P6IE: Port 6 input enable control register
+SFRX(P6IE, 0xFE36);
+
+// SFR P7IE: Port 7 input enable control register
+SFRX(P7IE, 0xFE37);
+
 // SFR I2CCFG: I2C configuration register
 SFRX(I2CCFG, 0xFE80);
 #define MSSPEED0 0x1
@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _BIT_BANGING_H
+#define _BIT_BANGING_H
+
+/**
+ * @file bit-banging.h
+ * 
+ * Compile-time calibration shared by the bit-banged SPI and I2C masters.
+ * 
+ * Half clock periods are padded with the same empty loop as delay10us() 
+ * (see ../delay-loops), whose cost per iteration was measured there. 
+ * The cost of the pin accesses around each half period comes from the 
+ * instruction timing tables of each family, and is subtracted from the 
+ * padding so the resulting clock rate is the one requested, or the 
+ * highest achievable one when F_CPU is too low for it.
+ * 
+ * **IMPORTANT:** symbols whose names beginning with 2 underscores are 
+ * used internally by the driver.
+ */
+
+#if defined(_STC8AF_H) || defined(_STC8G_H) || defined(_STC8H_H)
+#define __BITBANG_LOOP_CYCLES 6UL
+#define __BITBANG_LOOP_SETUP_CYCLES 2UL
+#define __BITBANG_PIN_CYCLES 1UL
+#elif defined(_STC15_H) || defined(_STC12_H)
+#define __BITBANG_LOOP_CYCLES 10UL
+#define __BITBANG_LOOP_SETUP_CYCLES 3UL
+#define __BITBANG_PIN_CYCLES 3UL
+#elif defined(_STC90_H)
+#define __BITBANG_LOOP_CYCLES (6UL * T_CPU)
+#define __BITBANG_LOOP_SETUP_CYCLES (2UL * T_CPU)
+#define __BITBANG_PIN_CYCLES (1UL * T_CPU)
+#else
+#error "Unsupported MCU family"
+#endif
+
+/**
+ * Number of delay loop iterations needed to pad a half clock period 
+ * at the given rate (in Hz), given the number of clock cycles the code 
+ * already spends in it. 0 means no padding at all.
+ */
+#define __BITBANG_DELAY_LOOPS(rate, busyCycles) \
+	((F_CPU / (2UL * (rate)) > (busyCycles) + __BITBANG_LOOP_SETUP_CYCLES) ? \
+	((F_CPU / (2UL * (rate)) - (busyCycles) - __BITBANG_LOOP_SETUP_CYCLES + __BITBANG_LOOP_CYCLES / 2UL) / __BITBANG_LOOP_CYCLES) : 0UL)
+
+#define __BITBANG_DELAY(loops) for (unsigned char __n = (loops); __n; __n--) {}
+
+#endif // _BIT_BANGING_H
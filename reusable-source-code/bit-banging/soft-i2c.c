@@ -0,0 +1,168 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "bit-banging.h"
+#include "soft-i2c.h"
+
+/**
+ * @file soft-i2c.c
+ * 
+ * Bit-banged I2C master: implementation.
+ */
+
+#if !defined(SOFT_I2C_SCL) || !defined(SOFT_I2C_SDA)
+#error "SOFT_I2C_SCL and SOFT_I2C_SDA must be defined in project-defs.h"
+#endif
+
+#ifndef SOFT_I2C_CLOCK_HZ
+#define SOFT_I2C_CLOCK_HZ 100000UL
+#endif // SOFT_I2C_CLOCK_HZ
+
+/*
+ * Each half bit spends about 4 pin accesses (SDA, SCL, and the clock 
+ * stretching test) besides the padding loop.
+ */
+#define __SOFT_I2C_DELAY_LOOPS __BITBANG_DELAY_LOOPS(SOFT_I2C_CLOCK_HZ, 4UL * __BITBANG_PIN_CYCLES)
+
+#if __SOFT_I2C_DELAY_LOOPS > 255
+#error "SOFT_I2C_CLOCK_HZ is too low for F_CPU"
+#endif
+
+#if __SOFT_I2C_DELAY_LOOPS
+#define __softi2c_delay() __BITBANG_DELAY(__SOFT_I2C_DELAY_LOOPS)
+#else
+#define __softi2c_delay()
+#endif
+
+inline void __softi2c_releaseClock() {
+	SOFT_I2C_SCL = 1;
+	
+	// Wait for slaves stretching the clock.
+	while (!SOFT_I2C_SCL);
+}
+
+inline void __softi2c_writeBit(uint8_t bit) {
+	SOFT_I2C_SDA = bit ? 1 : 0;
+	__softi2c_delay();
+	__softi2c_releaseClock();
+	__softi2c_delay();
+	SOFT_I2C_SCL = 0;
+}
+
+inline uint8_t __softi2c_readBit() {
+	uint8_t bit;
+	
+	SOFT_I2C_SDA = 1;
+	__softi2c_delay();
+	__softi2c_releaseClock();
+	__softi2c_delay();
+	bit = SOFT_I2C_SDA;
+	SOFT_I2C_SCL = 0;
+	
+	return bit;
+}
+
+void softi2c_initialise() {
+	SOFT_I2C_SDA = 1;
+	SOFT_I2C_SCL = 1;
+}
+
+void softi2c_start() {
+	SOFT_I2C_SDA = 1;
+	__softi2c_delay();
+	__softi2c_releaseClock();
+	__softi2c_delay();
+	SOFT_I2C_SDA = 0;
+	__softi2c_delay();
+	SOFT_I2C_SCL = 0;
+}
+
+void softi2c_stop() {
+	SOFT_I2C_SDA = 0;
+	__softi2c_delay();
+	__softi2c_releaseClock();
+	__softi2c_delay();
+	SOFT_I2C_SDA = 1;
+	__softi2c_delay();
+}
+
+uint8_t softi2c_write(uint8_t value) {
+	for (uint8_t n = 8; n; n--) {
+		__softi2c_writeBit(value & 0x80);
+		value <<= 1;
+	}
+	
+	// The slave acknowledges by pulling SDA low.
+	return !__softi2c_readBit();
+}
+
+uint8_t softi2c_read(uint8_t ack) {
+	uint8_t value = 0;
+	
+	for (uint8_t n = 8; n; n--) {
+		value = (value << 1) | __softi2c_readBit();
+	}
+	
+	__softi2c_writeBit(!ack);
+	
+	return value;
+}
+
+uint8_t softi2c_transmit(uint8_t address, const uint8_t *data, uint8_t length) {
+	uint8_t result;
+	
+	softi2c_start();
+	result = softi2c_write(address << 1);
+	
+	while (result && length--) {
+		result = softi2c_write(*data++);
+	}
+	
+	softi2c_stop();
+	
+	return result;
+}
+
+uint8_t softi2c_receive(uint8_t address, uint8_t *data, uint8_t length) {
+	uint8_t result;
+	
+	softi2c_start();
+	result = softi2c_write((address << 1) | 1);
+	
+	if (result) {
+		while (length--) {
+			*data++ = softi2c_read(length);
+		}
+	}
+	
+	softi2c_stop();
+	
+	return result;
+}
@@ -0,0 +1,99 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _SOFT_I2C_H
+#define _SOFT_I2C_H
+
+#include <stdint.h>
+
+/**
+ * @file soft-i2c.h
+ * 
+ * Bit-banged I2C master: definitions.
+ * 
+ * Pins and clock rate are fixed at compile time in project-defs.h, e.g.
+ * 
+ * #define SOFT_I2C_SCL P3_2
+ * #define SOFT_I2C_SDA P3_3
+ * #define SOFT_I2C_CLOCK_HZ 400000UL
+ * 
+ * SOFT_I2C_CLOCK_HZ defaults to 100 kHz. Both pins must be configured 
+ * as open-drain, or bidirectional, with pull-up resistors.
+ * 
+ * Slaves stretching the clock are waited for.
+ * 
+ * Supported MCU families: STC90, STC12, STC15, STC8A/F/G/H.
+ */
+
+/**
+ * Releases both lines.
+ */
+void softi2c_initialise();
+
+/**
+ * Sends a START condition, or a repeated START if the bus is already 
+ * ours.
+ */
+void softi2c_start();
+
+/**
+ * Sends a STOP condition.
+ */
+void softi2c_stop();
+
+/**
+ * Sends a byte.
+ * 
+ * @returns non-zero if the slave acknowledged it.
+ */
+uint8_t softi2c_write(uint8_t value);
+
+/**
+ * Receives a byte, and acknowledges it if ack is non-zero (i.e. for 
+ * all bytes but the last one).
+ */
+uint8_t softi2c_read(uint8_t ack);
+
+/**
+ * Sends length bytes to the slave with the given 7-bit address, 
+ * between a START and a STOP condition.
+ * 
+ * @returns non-zero if all bytes were acknowledged.
+ */
+uint8_t softi2c_transmit(uint8_t address, const uint8_t *data, uint8_t length);
+
+/**
+ * Receives length bytes from the slave with the given 7-bit address, 
+ * between a START and a STOP condition.
+ * 
+ * @returns non-zero if the slave acknowledged its address.
+ */
+uint8_t softi2c_receive(uint8_t address, uint8_t *data, uint8_t length);
+
+#endif // _SOFT_I2C_H
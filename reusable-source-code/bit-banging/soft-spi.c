@@ -0,0 +1,141 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "bit-banging.h"
+#include "soft-spi.h"
+
+/**
+ * @file soft-spi.c
+ * 
+ * Bit-banged SPI master: implementation.
+ * 
+ * Bits are sent by an unrolled sequence of sbit accesses, i.e. without 
+ * any loop or shift: without SOFT_SPI_CLOCK_HZ, a bit takes about 
+ * a dozen clock cycles on an STC8, i.e. close to 1 MHz at 11.0592 MHz.
+ */
+
+#if !defined(SOFT_SPI_SCK) || !defined(SOFT_SPI_MOSI)
+#error "SOFT_SPI_SCK and SOFT_SPI_MOSI must be defined in project-defs.h"
+#endif
+
+#ifndef SOFT_SPI_MODE
+#define SOFT_SPI_MODE 0
+#endif // SOFT_SPI_MODE
+
+#if SOFT_SPI_MODE < 0 || SOFT_SPI_MODE > 3
+#error "SOFT_SPI_MODE must be between 0 and 3"
+#endif
+
+#define __SOFT_SPI_CPOL (SOFT_SPI_MODE >> 1)
+#define __SOFT_SPI_CPHA (SOFT_SPI_MODE & 1)
+
+#define __softspi_leadingEdge() SOFT_SPI_SCK = !__SOFT_SPI_CPOL
+#define __softspi_trailingEdge() SOFT_SPI_SCK = __SOFT_SPI_CPOL
+
+/*
+ * Each half bit spends about 3 pin accesses (MOSI or MISO test and 
+ * update, SCK) besides the padding loop.
+ */
+#ifdef SOFT_SPI_CLOCK_HZ
+#define __SOFT_SPI_DELAY_LOOPS __BITBANG_DELAY_LOOPS(SOFT_SPI_CLOCK_HZ, 3UL * __BITBANG_PIN_CYCLES)
+
+#if __SOFT_SPI_DELAY_LOOPS > 255
+#error "SOFT_SPI_CLOCK_HZ is too low for F_CPU"
+#endif
+#else
+#define __SOFT_SPI_DELAY_LOOPS 0
+#endif // SOFT_SPI_CLOCK_HZ
+
+#if __SOFT_SPI_DELAY_LOOPS
+#define __softspi_delay() __BITBANG_DELAY(__SOFT_SPI_DELAY_LOOPS)
+#else
+#define __softspi_delay()
+#endif
+
+#ifdef SOFT_SPI_MISO
+#define __softspi_sample(mask) if (SOFT_SPI_MISO) received |= (mask)
+#else
+#define __softspi_sample(mask)
+#endif // SOFT_SPI_MISO
+
+#if __SOFT_SPI_CPHA == 0
+// Data is output before the leading edge and sampled on it.
+#define __softspi_bit(mask) \
+	SOFT_SPI_MOSI = (value & (mask)) ? 1 : 0; \
+	__softspi_delay(); \
+	__softspi_leadingEdge(); \
+	__softspi_sample(mask); \
+	__softspi_delay(); \
+	__softspi_trailingEdge()
+#else
+// Data is output on the leading edge and sampled on the trailing one.
+#define __softspi_bit(mask) \
+	__softspi_leadingEdge(); \
+	SOFT_SPI_MOSI = (value & (mask)) ? 1 : 0; \
+	__softspi_delay(); \
+	__softspi_trailingEdge(); \
+	__softspi_sample(mask); \
+	__softspi_delay()
+#endif // __SOFT_SPI_CPHA
+
+void softspi_initialise() {
+	__softspi_trailingEdge();
+}
+
+uint8_t softspi_transfer(uint8_t value) {
+#ifdef SOFT_SPI_MISO
+	uint8_t received = 0;
+#else
+	uint8_t received = 0xff;
+#endif // SOFT_SPI_MISO
+	
+	__softspi_bit(0x80);
+	__softspi_bit(0x40);
+	__softspi_bit(0x20);
+	__softspi_bit(0x10);
+	__softspi_bit(0x08);
+	__softspi_bit(0x04);
+	__softspi_bit(0x02);
+	__softspi_bit(0x01);
+	
+	return received;
+}
+
+void softspi_write(const uint8_t *data, uint8_t length) {
+	while (length--) {
+		softspi_transfer(*data++);
+	}
+}
+
+void softspi_read(uint8_t *data, uint8_t length) {
+	while (length--) {
+		*data++ = softspi_transfer(0xff);
+	}
+}
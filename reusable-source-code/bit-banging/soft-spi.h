@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _SOFT_SPI_H
+#define _SOFT_SPI_H
+
+#include <stdint.h>
+
+/**
+ * @file soft-spi.h
+ * 
+ * Bit-banged SPI master: definitions.
+ * 
+ * Pins, mode and clock rate are fixed at compile time in 
+ * project-defs.h, e.g.
+ * 
+ * #define SOFT_SPI_SCK P1_7
+ * #define SOFT_SPI_MOSI P1_5
+ * #define SOFT_SPI_MISO P1_6
+ * #define SOFT_SPI_MODE 0
+ * #define SOFT_SPI_CLOCK_HZ 1000000UL
+ * 
+ * SOFT_SPI_MISO may be omitted for write-only devices. SOFT_SPI_MODE 
+ * defaults to 0, and SOFT_SPI_CLOCK_HZ to the highest rate achievable.
+ * 
+ * Chip select is left to the application, e.g. with GPIO_PIN_CLEAR() 
+ * and GPIO_PIN_SET() from ../gpio/gpio.h.
+ * 
+ * Supported MCU families: STC90, STC12, STC15, STC8A/F/G/H.
+ */
+
+/**
+ * Sets SCK to its idle level. Pins must be configured separately 
+ * (e.g. push-pull for SCK and MOSI, input or bidirectional for MISO).
+ */
+void softspi_initialise();
+
+/**
+ * Sends a byte, most significant bit first, and returns the byte 
+ * received meanwhile (0xff without SOFT_SPI_MISO).
+ */
+uint8_t softspi_transfer(uint8_t value);
+
+/**
+ * Sends length bytes, discarding those received.
+ */
+void softspi_write(const uint8_t *data, uint8_t length);
+
+/**
+ * Receives length bytes, sending 0xff meanwhile.
+ */
+void softspi_read(uint8_t *data, uint8_t length);
+
+#endif // _SOFT_SPI_H
@@ -0,0 +1,218 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "gpio.h"
+#include "debounce.h"
+
+/**
+ * @file debounce.c
+ * 
+ * Input debouncing driven by a periodic timer interrupt: implementation.
+ */
+
+#ifndef DEBOUNCE_TICK_MS
+#define DEBOUNCE_TICK_MS 5
+#endif // DEBOUNCE_TICK_MS
+
+// The timer is clocked at SYSclk/12.
+#define __DEBOUNCE_COUNTS ((F_CPU / 1000UL * DEBOUNCE_TICK_MS + 6UL) / 12UL)
+
+#if __DEBOUNCE_COUNTS > 65536UL
+#error "DEBOUNCE_TICK_MS is too long for F_CPU"
+#endif
+
+#define __DEBOUNCE_RELOAD (65536UL - __DEBOUNCE_COUNTS)
+
+#if DEBOUNCE_TIMER == 0
+#define __DEBOUNCE_TL TL0
+#define __DEBOUNCE_TH TH0
+#define __DEBOUNCE_TR TR0
+#define __DEBOUNCE_TF TF0
+#define __DEBOUNCE_ET ET0
+#define __DEBOUNCE_TMOD_MASK 0xF0
+#define __DEBOUNCE_TMOD T0_M0
+#define __DEBOUNCE_INTERRUPT TIMER0_INTERRUPT
+#define __DEBOUNCE_X12 T0x12
+#elif DEBOUNCE_TIMER == 1
+#define __DEBOUNCE_TL TL1
+#define __DEBOUNCE_TH TH1
+#define __DEBOUNCE_TR TR1
+#define __DEBOUNCE_TF TF1
+#define __DEBOUNCE_ET ET1
+#define __DEBOUNCE_TMOD_MASK 0x0F
+#define __DEBOUNCE_TMOD T1_M0
+#define __DEBOUNCE_INTERRUPT TIMER1_INTERRUPT
+#define __DEBOUNCE_X12 T1x12
+#else
+#error "DEBOUNCE_TIMER must be 0 or 1"
+#endif // DEBOUNCE_TIMER
+
+#ifdef __GPIO_HAS_PORTS67
+#define __DEBOUNCE_PORT_COUNT 8
+#else
+#define __DEBOUNCE_PORT_COUNT 6
+#endif // __GPIO_HAS_PORTS67
+
+// Pins being debounced, per port.
+unsigned char __debounce_masks[__DEBOUNCE_PORT_COUNT];
+// Debounced state of the ports.
+volatile unsigned char __debounce_states[__DEBOUNCE_PORT_COUNT];
+// Vertical counters: bit n of each counts the consecutive samples 
+// of pin n that differ from its debounced state.
+unsigned char __debounce_counts0[__DEBOUNCE_PORT_COUNT];
+unsigned char __debounce_counts1[__DEBOUNCE_PORT_COUNT];
+// Pins whose debounced state changed, not reported yet.
+volatile unsigned char __debounce_falling[__DEBOUNCE_PORT_COUNT];
+volatile unsigned char __debounce_rising[__DEBOUNCE_PORT_COUNT];
+
+inline void __debounce_sample(unsigned char port, unsigned char sample) {
+	unsigned char changed = sample ^ __debounce_states[port];
+	
+	// Count up where the sample differs from the debounced state, 
+	// reset elsewhere. Counters wrap to 0 on the 4th sample in a row.
+	__debounce_counts1[port] = (__debounce_counts1[port] ^ __debounce_counts0[port]) & changed;
+	__debounce_counts0[port] = ~__debounce_counts0[port] & changed;
+	changed &= ~(__debounce_counts0[port] | __debounce_counts1[port]);
+	
+	if (changed) {
+		unsigned char state = __debounce_states[port] ^ changed;
+		__debounce_states[port] = state;
+		__debounce_rising[port] |= changed & state;
+		__debounce_falling[port] |= changed & ~state;
+	}
+}
+
+void __debounce_timer_isr() __interrupt __DEBOUNCE_INTERRUPT __using 1 __critical {
+	__DEBOUNCE_TL = (unsigned char) (__DEBOUNCE_RELOAD & 0xFF);
+	__DEBOUNCE_TH = (unsigned char) (__DEBOUNCE_RELOAD >> 8);
+	
+	if (__debounce_masks[0]) {
+		__debounce_sample(0, P0);
+	}
+	if (__debounce_masks[1]) {
+		__debounce_sample(1, P1);
+	}
+	if (__debounce_masks[2]) {
+		__debounce_sample(2, P2);
+	}
+	if (__debounce_masks[3]) {
+		__debounce_sample(3, P3);
+	}
+	if (__debounce_masks[4]) {
+		__debounce_sample(4, P4);
+	}
+	if (__debounce_masks[5]) {
+		__debounce_sample(5, P5);
+	}
+
+#ifdef __GPIO_HAS_PORTS67
+	if (__debounce_masks[6]) {
+		__debounce_sample(6, P6);
+	}
+	if (__debounce_masks[7]) {
+		__debounce_sample(7, P7);
+	}
+#endif // __GPIO_HAS_PORTS67
+}
+
+inline unsigned char __debounce_mask(const GpioConfig *config) {
+	return GPIO_FIELD_MASK(config->pin, config->count) & __debounce_masks[config->port];
+}
+
+/**
+ * Returns and clears the bits of an edge accumulator selected by config.
+ */
+inline unsigned char __debounce_takeEdges(volatile unsigned char *edges, const GpioConfig *config) {
+	unsigned char mask = __debounce_mask(config);
+	
+	__DEBOUNCE_ET = 0;
+	unsigned char value = edges[config->port] & mask;
+	edges[config->port] &= ~mask;
+	__DEBOUNCE_ET = 1;
+	
+	return value >> config->pin;
+}
+
+void debounce_initialise(const GpioConfig *configs, unsigned char count) {
+	for (unsigned char port = 0; port < __DEBOUNCE_PORT_COUNT; port++) {
+		__debounce_masks[port] = 0;
+		__debounce_counts0[port] = 0;
+		__debounce_counts1[port] = 0;
+		__debounce_falling[port] = 0;
+		__debounce_rising[port] = 0;
+	}
+	
+	for (unsigned char i = 0; i < count; i++) {
+		__debounce_masks[configs[i].port] |= GPIO_FIELD_MASK(configs[i].pin, configs[i].count);
+	}
+	
+	// Start from the current state of the pins, without any edge.
+	__debounce_states[0] = P0;
+	__debounce_states[1] = P1;
+	__debounce_states[2] = P2;
+	__debounce_states[3] = P3;
+	__debounce_states[4] = P4;
+	__debounce_states[5] = P5;
+
+#ifdef __GPIO_HAS_PORTS67
+	__debounce_states[6] = P6;
+	__debounce_states[7] = P7;
+#endif // __GPIO_HAS_PORTS67
+	
+	// Timer in mode 1 (16-bit, no auto-reload) at SYSclk/12.
+	__DEBOUNCE_TR = 0;
+	TMOD = (TMOD & __DEBOUNCE_TMOD_MASK) | __DEBOUNCE_TMOD;
+	AUXR &= ~__DEBOUNCE_X12;
+	__DEBOUNCE_TL = (unsigned char) (__DEBOUNCE_RELOAD & 0xFF);
+	__DEBOUNCE_TH = (unsigned char) (__DEBOUNCE_RELOAD >> 8);
+	__DEBOUNCE_TF = 0;
+	__DEBOUNCE_ET = 1;
+	__DEBOUNCE_TR = 1;
+}
+
+unsigned char debounce_read(const GpioConfig *config) {
+	return (__debounce_states[config->port] & __debounce_mask(config)) >> config->pin;
+}
+
+unsigned char debounce_pressed(const GpioConfig *config) {
+#ifdef DEBOUNCE_ACTIVE_HIGH
+	return __debounce_takeEdges(__debounce_rising, config);
+#else
+	return __debounce_takeEdges(__debounce_falling, config);
+#endif // DEBOUNCE_ACTIVE_HIGH
+}
+
+unsigned char debounce_released(const GpioConfig *config) {
+#ifdef DEBOUNCE_ACTIVE_HIGH
+	return __debounce_takeEdges(__debounce_falling, config);
+#else
+	return __debounce_takeEdges(__debounce_rising, config);
+#endif // DEBOUNCE_ACTIVE_HIGH
+}
@@ -0,0 +1,89 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _DEBOUNCE_H
+#define _DEBOUNCE_H
+
+/**
+ * @file debounce.h
+ * 
+ * Input debouncing driven by a periodic timer interrupt: definitions.
+ * 
+ * Whole ports are sampled every DEBOUNCE_TICK_MS milliseconds (5 by 
+ * default) and filtered with 2-bit vertical counters, so a pin must 
+ * keep the same level for 4 consecutive samples before its debounced 
+ * state changes. All 8 pins of a port are processed in parallel.
+ * 
+ * Timer 1 is used by default; define DEBOUNCE_TIMER as 0 in 
+ * project-defs.h to use Timer 0 instead.
+ * 
+ * Supported MCU families: STC12, STC15, STC8A, STC8F, STC8G, STC8H.
+ */
+
+/**
+ * Starts debouncing the pins described by an array of GpioConfig. 
+ * Only .port, .pin and .count are used: pins must be configured as 
+ * inputs separately (e.g. with gpio_configure() or gpio_configureAll()).
+ * 
+ * The array may be in code memory.
+ */
+void debounce_initialise(const GpioConfig *configs, unsigned char count);
+
+/**
+ * Returns the debounced state of a pin, or series of consecutive pins, 
+ * shifted like gpio_read() does.
+ */
+unsigned char debounce_read(const GpioConfig *config);
+
+/**
+ * Returns which of the pins described by config went low since the 
+ * last call, shifted like gpio_read() does, and forgets about them.
+ * 
+ * Buttons usually pull inputs low, so these are "pressed" events. 
+ * Define DEBOUNCE_ACTIVE_HIGH in project-defs.h to swap 
+ * debounce_pressed() and debounce_released().
+ */
+unsigned char debounce_pressed(const GpioConfig *config);
+
+/**
+ * Same as debounce_pressed() for pins which went high.
+ */
+unsigned char debounce_released(const GpioConfig *config);
+
+#ifndef DEBOUNCE_TIMER
+#define DEBOUNCE_TIMER 1
+#endif // DEBOUNCE_TIMER
+
+#if DEBOUNCE_TIMER == 0
+void __debounce_timer_isr() __interrupt TIMER0_INTERRUPT __using 1;
+#else
+void __debounce_timer_isr() __interrupt TIMER1_INTERRUPT __using 1;
+#endif // DEBOUNCE_TIMER
+
+#endif // _DEBOUNCE_H
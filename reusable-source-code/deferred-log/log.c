@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "console.h"
+#include "log.h"
+
+/**
+ * @file log.c
+ * 
+ * Deferred logging over the serial console: implementation.
+ * 
+ * Records are assembled here, then placed in the console's output 
+ * buffer with a single console_write() call.
+ */
+
+// Marker, format string address and up to 3 arguments, little-endian.
+uint8_t __log_buffer[9];
+
+void __log_start(const __code char *format) {
+	__log_buffer[0] = LOG_RECORD_MARKER;
+	__log_buffer[1] = (uint16_t) format & 0xFF;
+	__log_buffer[2] = (uint16_t) format >> 8;
+}
+
+void __log_record0(const __code char *format) {
+	__log_start(format);
+	console_write(__log_buffer, 3);
+}
+
+void __log_record1(const __code char *format, uint16_t a) {
+	__log_start(format);
+	__log_buffer[3] = a & 0xFF;
+	__log_buffer[4] = a >> 8;
+	console_write(__log_buffer, 5);
+}
+
+void __log_record2(const __code char *format, uint16_t a, uint16_t b) {
+	__log_start(format);
+	__log_buffer[3] = a & 0xFF;
+	__log_buffer[4] = a >> 8;
+	__log_buffer[5] = b & 0xFF;
+	__log_buffer[6] = b >> 8;
+	console_write(__log_buffer, 7);
+}
+
+void __log_record3(const __code char *format, uint16_t a, uint16_t b, uint16_t c) {
+	__log_start(format);
+	__log_buffer[3] = a & 0xFF;
+	__log_buffer[4] = a >> 8;
+	__log_buffer[5] = b & 0xFF;
+	__log_buffer[6] = b >> 8;
+	__log_buffer[7] = c & 0xFF;
+	__log_buffer[8] = c >> 8;
+	console_write(__log_buffer, 9);
+}
@@ -0,0 +1,94 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _LOG_H
+#define _LOG_H
+
+#include <stdint.h>
+
+/**
+ * @file log.h
+ * 
+ * Deferred logging over the serial console: definitions.
+ * 
+ * Log statements don't format anything: they send a record made of 
+ * the address of their format string in code memory, followed by 
+ * their arguments in binary form. log-decoder rebuilds the text on 
+ * the host, reading format strings from the firmware's .ihx file.
+ * 
+ * Arguments are 16-bit integers, matching the following conversions: 
+ * %d, %u, %x, %X and %c, and %s for strings in code memory. Field 
+ * widths (e.g. %04x) are supported as well. At most 3 arguments are 
+ * supported.
+ * 
+ * **IMPORTANT:** LOG() must not be called from interrupt service 
+ * routines: records are built in a single shared buffer.
+ */
+
+/**
+ * First byte of each record, allowing log-decoder to tell records 
+ * from text sent by other means (e.g. printf).
+ */
+#define LOG_RECORD_MARKER 0x1E
+
+void __log_record0(const __code char *format);
+void __log_record1(const __code char *format, uint16_t a);
+void __log_record2(const __code char *format, uint16_t a, uint16_t b);
+void __log_record3(const __code char *format, uint16_t a, uint16_t b, uint16_t c);
+
+#define __LOG0(format) do { \
+	static const __code char __logFormat[] = format; \
+	__log_record0(__logFormat); \
+} while (0)
+
+#define __LOG1(format, a) do { \
+	static const __code char __logFormat[] = format; \
+	__log_record1(__logFormat, (uint16_t) (a)); \
+} while (0)
+
+#define __LOG2(format, a, b) do { \
+	static const __code char __logFormat[] = format; \
+	__log_record2(__logFormat, (uint16_t) (a), (uint16_t) (b)); \
+} while (0)
+
+#define __LOG3(format, a, b, c) do { \
+	static const __code char __logFormat[] = format; \
+	__log_record3(__logFormat, (uint16_t) (a), (uint16_t) (b), (uint16_t) (c)); \
+} while (0)
+
+#define __LOG_SELECT(_1, _2, _3, _4, name, ...) name
+
+/**
+ * Sends a log record, e.g. LOG("temperature = %d\n", temperature);
+ * 
+ * The format string MUST be a string literal.
+ */
+#define LOG(...) __LOG_SELECT(__VA_ARGS__, __LOG3, __LOG2, __LOG1, __LOG0, _)(__VA_ARGS__)
+
+#endif // _LOG_H
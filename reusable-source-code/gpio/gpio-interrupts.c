@@ -0,0 +1,262 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "gpio.h"
+#include "gpio-interrupts.h"
+
+/**
+ * @file gpio-interrupts.c
+ * 
+ * STC8H port interrupt dispatcher: implementation.
+ * 
+ * ISRs deliberately don't use a separate register bank since handlers 
+ * are ordinary functions compiled for bank 0.
+ */
+
+#ifndef __GPIO_EVOLUTION3
+#error "Port interrupts are only supported by the STC8H family."
+#endif // __GPIO_EVOLUTION3
+
+/**
+ * Calls the handlers of the pins whose flags are set.
+ */
+inline void __gpio_dispatch(unsigned char flags, GpioInterruptHandler *handlers) {
+	for (; flags; flags >>= 1, handlers++) {
+		if ((flags & 1) && *handlers) {
+			(*handlers)();
+		}
+	}
+}
+
+#ifdef GPIO_USE_PORT0_INTERRUPTS
+GpioInterruptHandler __gpio_port0Handlers[8];
+
+void __gpio_port0_isr() __interrupt GPIO_PORT0_INTERRUPT {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	unsigned char flags = P0INTF;
+	P0INTF &= ~flags;
+	P_SW2 = savedPSW2;
+	
+	__gpio_dispatch(flags, __gpio_port0Handlers);
+}
+#endif // GPIO_USE_PORT0_INTERRUPTS
+
+#ifdef GPIO_USE_PORT1_INTERRUPTS
+GpioInterruptHandler __gpio_port1Handlers[8];
+
+void __gpio_port1_isr() __interrupt GPIO_PORT1_INTERRUPT {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	unsigned char flags = P1INTF;
+	P1INTF &= ~flags;
+	P_SW2 = savedPSW2;
+	
+	__gpio_dispatch(flags, __gpio_port1Handlers);
+}
+#endif // GPIO_USE_PORT1_INTERRUPTS
+
+#ifdef GPIO_USE_PORT2_INTERRUPTS
+GpioInterruptHandler __gpio_port2Handlers[8];
+
+void __gpio_port2_isr() __interrupt GPIO_PORT2_INTERRUPT {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	unsigned char flags = P2INTF;
+	P2INTF &= ~flags;
+	P_SW2 = savedPSW2;
+	
+	__gpio_dispatch(flags, __gpio_port2Handlers);
+}
+#endif // GPIO_USE_PORT2_INTERRUPTS
+
+#ifdef GPIO_USE_PORT3_INTERRUPTS
+GpioInterruptHandler __gpio_port3Handlers[8];
+
+void __gpio_port3_isr() __interrupt GPIO_PORT3_INTERRUPT {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	unsigned char flags = P3INTF;
+	P3INTF &= ~flags;
+	P_SW2 = savedPSW2;
+	
+	__gpio_dispatch(flags, __gpio_port3Handlers);
+}
+#endif // GPIO_USE_PORT3_INTERRUPTS
+
+#ifdef GPIO_USE_PORT4_INTERRUPTS
+GpioInterruptHandler __gpio_port4Handlers[8];
+
+void __gpio_port4_isr() __interrupt GPIO_PORT4_INTERRUPT {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	unsigned char flags = P4INTF;
+	P4INTF &= ~flags;
+	P_SW2 = savedPSW2;
+	
+	__gpio_dispatch(flags, __gpio_port4Handlers);
+}
+#endif // GPIO_USE_PORT4_INTERRUPTS
+
+#ifdef GPIO_USE_PORT5_INTERRUPTS
+GpioInterruptHandler __gpio_port5Handlers[8];
+
+void __gpio_port5_isr() __interrupt GPIO_PORT5_INTERRUPT {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	unsigned char flags = P5INTF;
+	P5INTF &= ~flags;
+	P_SW2 = savedPSW2;
+	
+	__gpio_dispatch(flags, __gpio_port5Handlers);
+}
+#endif // GPIO_USE_PORT5_INTERRUPTS
+
+#ifdef GPIO_USE_PORT6_INTERRUPTS
+GpioInterruptHandler __gpio_port6Handlers[8];
+
+void __gpio_port6_isr() __interrupt GPIO_PORT6_INTERRUPT {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	unsigned char flags = P6INTF;
+	P6INTF &= ~flags;
+	P_SW2 = savedPSW2;
+	
+	__gpio_dispatch(flags, __gpio_port6Handlers);
+}
+#endif // GPIO_USE_PORT6_INTERRUPTS
+
+#ifdef GPIO_USE_PORT7_INTERRUPTS
+GpioInterruptHandler __gpio_port7Handlers[8];
+
+void __gpio_port7_isr() __interrupt GPIO_PORT7_INTERRUPT {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	unsigned char flags = P7INTF;
+	P7INTF &= ~flags;
+	P_SW2 = savedPSW2;
+	
+	__gpio_dispatch(flags, __gpio_port7Handlers);
+}
+#endif // GPIO_USE_PORT7_INTERRUPTS
+
+/*
+ * Redirect the vectors of the ports in use to their ISR.
+ */
+void __gpio_portVectors() __naked {
+	__asm
+		.area GPIO_PORT_VECTORS (ABS, CODE)
+#ifdef GPIO_USE_PORT0_INTERRUPTS
+		.org P0_VECTOR_ADDR
+		ljmp ___gpio_port0_isr
+#endif // GPIO_USE_PORT0_INTERRUPTS
+#ifdef GPIO_USE_PORT1_INTERRUPTS
+		.org P1_VECTOR_ADDR
+		ljmp ___gpio_port1_isr
+#endif // GPIO_USE_PORT1_INTERRUPTS
+#ifdef GPIO_USE_PORT2_INTERRUPTS
+		.org P2_VECTOR_ADDR
+		ljmp ___gpio_port2_isr
+#endif // GPIO_USE_PORT2_INTERRUPTS
+#ifdef GPIO_USE_PORT3_INTERRUPTS
+		.org P3_VECTOR_ADDR
+		ljmp ___gpio_port3_isr
+#endif // GPIO_USE_PORT3_INTERRUPTS
+#ifdef GPIO_USE_PORT4_INTERRUPTS
+		.org P4_VECTOR_ADDR
+		ljmp ___gpio_port4_isr
+#endif // GPIO_USE_PORT4_INTERRUPTS
+#ifdef GPIO_USE_PORT5_INTERRUPTS
+		.org P5_VECTOR_ADDR
+		ljmp ___gpio_port5_isr
+#endif // GPIO_USE_PORT5_INTERRUPTS
+#ifdef GPIO_USE_PORT6_INTERRUPTS
+		.org P6_VECTOR_ADDR
+		ljmp ___gpio_port6_isr
+#endif // GPIO_USE_PORT6_INTERRUPTS
+#ifdef GPIO_USE_PORT7_INTERRUPTS
+		.org P7_VECTOR_ADDR
+		ljmp ___gpio_port7_isr
+#endif // GPIO_USE_PORT7_INTERRUPTS
+		.area CSEG (CODE)
+	__endasm;
+}
+
+void gpio_setInterruptHandler(GpioPort port, GpioPin pin, GpioInterruptHandler handler) {
+	switch (port) {
+#ifdef GPIO_USE_PORT0_INTERRUPTS
+	case GPIO_PORT0:
+		__gpio_port0Handlers[pin] = handler;
+		break;
+#endif // GPIO_USE_PORT0_INTERRUPTS
+	
+#ifdef GPIO_USE_PORT1_INTERRUPTS
+	case GPIO_PORT1:
+		__gpio_port1Handlers[pin] = handler;
+		break;
+#endif // GPIO_USE_PORT1_INTERRUPTS
+	
+#ifdef GPIO_USE_PORT2_INTERRUPTS
+	case GPIO_PORT2:
+		__gpio_port2Handlers[pin] = handler;
+		break;
+#endif // GPIO_USE_PORT2_INTERRUPTS
+	
+#ifdef GPIO_USE_PORT3_INTERRUPTS
+	case GPIO_PORT3:
+		__gpio_port3Handlers[pin] = handler;
+		break;
+#endif // GPIO_USE_PORT3_INTERRUPTS
+	
+#ifdef GPIO_USE_PORT4_INTERRUPTS
+	case GPIO_PORT4:
+		__gpio_port4Handlers[pin] = handler;
+		break;
+#endif // GPIO_USE_PORT4_INTERRUPTS
+	
+#ifdef GPIO_USE_PORT5_INTERRUPTS
+	case GPIO_PORT5:
+		__gpio_port5Handlers[pin] = handler;
+		break;
+#endif // GPIO_USE_PORT5_INTERRUPTS
+	
+#ifdef GPIO_USE_PORT6_INTERRUPTS
+	case GPIO_PORT6:
+		__gpio_port6Handlers[pin] = handler;
+		break;
+#endif // GPIO_USE_PORT6_INTERRUPTS
+	
+#ifdef GPIO_USE_PORT7_INTERRUPTS
+	case GPIO_PORT7:
+		__gpio_port7Handlers[pin] = handler;
+		break;
+#endif // GPIO_USE_PORT7_INTERRUPTS
+	}
+}
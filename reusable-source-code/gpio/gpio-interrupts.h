@@ -0,0 +1,131 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _GPIO_INTERRUPTS_H
+#define _GPIO_INTERRUPTS_H
+
+/**
+ * @file gpio-interrupts.h
+ * 
+ * STC8H port interrupt dispatcher: definitions.
+ * 
+ * Only the ports for which GPIO_USE_PORTn_INTERRUPTS is defined in 
+ * project-defs.h get an ISR, e.g.
+ * 
+ * #define GPIO_USE_PORT3_INTERRUPTS
+ * 
+ * Port interrupt vectors can't be declared directly in C (see STC8H 
+ * TRM appendix R): each of them jumps to an ISR declared with an 
+ * unused interrupt number, GPIO_PORTn_INTERRUPT, which may be 
+ * overridden in project-defs.h should it conflict with another one.
+ * 
+ * Pins are configured as usual with gpio_configure() or 
+ * gpio_configureAll() (.interrupts, .interruptMode and .wakeUp), and 
+ * this file must be included after gpio.h.
+ */
+
+typedef void (*GpioInterruptHandler)(void);
+
+/**
+ * Registers the function to call when an interrupt is triggered by 
+ * the given pin, or clears it when handler is NULL.
+ * 
+ * Handlers run in interrupt context: keep them short. Interrupt flags 
+ * are cleared before handlers are called.
+ * 
+ * Handlers should be registered before the corresponding pin's 
+ * interrupts are enabled.
+ */
+void gpio_setInterruptHandler(GpioPort port, GpioPin pin, GpioInterruptHandler handler);
+
+#ifdef GPIO_USE_PORT0_INTERRUPTS
+#ifndef GPIO_PORT0_INTERRUPT
+#define GPIO_PORT0_INTERRUPT 14
+#endif // GPIO_PORT0_INTERRUPT
+
+void __gpio_port0_isr() __interrupt GPIO_PORT0_INTERRUPT;
+#endif // GPIO_USE_PORT0_INTERRUPTS
+
+#ifdef GPIO_USE_PORT1_INTERRUPTS
+#ifndef GPIO_PORT1_INTERRUPT
+#define GPIO_PORT1_INTERRUPT 15
+#endif // GPIO_PORT1_INTERRUPT
+
+void __gpio_port1_isr() __interrupt GPIO_PORT1_INTERRUPT;
+#endif // GPIO_USE_PORT1_INTERRUPTS
+
+#ifdef GPIO_USE_PORT2_INTERRUPTS
+#ifndef GPIO_PORT2_INTERRUPT
+#define GPIO_PORT2_INTERRUPT 22
+#endif // GPIO_PORT2_INTERRUPT
+
+void __gpio_port2_isr() __interrupt GPIO_PORT2_INTERRUPT;
+#endif // GPIO_USE_PORT2_INTERRUPTS
+
+#ifdef GPIO_USE_PORT3_INTERRUPTS
+#ifndef GPIO_PORT3_INTERRUPT
+#define GPIO_PORT3_INTERRUPT 23
+#endif // GPIO_PORT3_INTERRUPT
+
+void __gpio_port3_isr() __interrupt GPIO_PORT3_INTERRUPT;
+#endif // GPIO_USE_PORT3_INTERRUPTS
+
+#ifdef GPIO_USE_PORT4_INTERRUPTS
+#ifndef GPIO_PORT4_INTERRUPT
+#define GPIO_PORT4_INTERRUPT 28
+#endif // GPIO_PORT4_INTERRUPT
+
+void __gpio_port4_isr() __interrupt GPIO_PORT4_INTERRUPT;
+#endif // GPIO_USE_PORT4_INTERRUPTS
+
+#ifdef GPIO_USE_PORT5_INTERRUPTS
+#ifndef GPIO_PORT5_INTERRUPT
+#define GPIO_PORT5_INTERRUPT 29
+#endif // GPIO_PORT5_INTERRUPT
+
+void __gpio_port5_isr() __interrupt GPIO_PORT5_INTERRUPT;
+#endif // GPIO_USE_PORT5_INTERRUPTS
+
+#ifdef GPIO_USE_PORT6_INTERRUPTS
+#ifndef GPIO_PORT6_INTERRUPT
+#define GPIO_PORT6_INTERRUPT 30
+#endif // GPIO_PORT6_INTERRUPT
+
+void __gpio_port6_isr() __interrupt GPIO_PORT6_INTERRUPT;
+#endif // GPIO_USE_PORT6_INTERRUPTS
+
+#ifdef GPIO_USE_PORT7_INTERRUPTS
+#ifndef GPIO_PORT7_INTERRUPT
+#define GPIO_PORT7_INTERRUPT 31
+#endif // GPIO_PORT7_INTERRUPT
+
+void __gpio_port7_isr() __interrupt GPIO_PORT7_INTERRUPT;
+#endif // GPIO_USE_PORT7_INTERRUPTS
+
+#endif // _GPIO_INTERRUPTS_H
@@ -44,11 +44,11 @@ inline unsigned char __gpio_setBits(unsigned char portValue, unsigned char cfgVa
 	return cfgValue ? (portValue | gpioConfig->__setMask) : (portValue & gpioConfig->__clearMask);
 }
 
-inline unsigned char __isOutput(GpioConfig *gpioConfig) {
+inline unsigned char __isOutput(const GpioConfig *gpioConfig) {
 	return gpioConfig->portMode == GPIO_BIDIRECTIONAL || gpioConfig->portMode == GPIO_PUSH_PULL || gpioConfig->portMode == GPIO_OPEN_DRAIN;
 }
 
-inline unsigned char __isInput(GpioConfig *gpioConfig) {
+inline unsigned char __isInput(const GpioConfig *gpioConfig) {
 	return gpioConfig->portMode == GPIO_BIDIRECTIONAL || gpioConfig->portMode == GPIO_HIGH_IMPEDANCE;
 }
 
@@ -228,7 +228,7 @@ void gpio_configure(GpioConfig *gpioConfig) {
 		P4IM0 = __gpio_setBits(P4IM0, gpioConfig->interruptMode & 1, gpioConfig);
 		P4INTF &= gpioConfig->__clearMask;
 		P4INTE = __gpio_setBits(P4INTE, gpioConfig->interrupts, gpioConfig);
-		P04WKUE = __gpio_setBits(P4WKUE, gpioConfig->wakeUp, gpioConfig);
+		P4WKUE = __gpio_setBits(P4WKUE, gpioConfig->wakeUp, gpioConfig);
 #endif // __GPIO_EVOLUTION3
 		
 		disableExtendedSFR();
@@ -341,6 +341,199 @@ void gpio_configure(GpioConfig *gpioConfig) {
 	}
 }
 
+#ifdef __GPIO_HAS_PORTS67
+#define __GPIO_PORT_COUNT 8
+#else
+#define __GPIO_PORT_COUNT 6
+#endif
+
+/**
+ * Registers merged by gpio_configureAll(). Each of them is written 
+ * exactly once per port.
+ */
+typedef enum {
+	__GPIO_M1 = 0,
+	__GPIO_M0,
+#ifdef __GPIO_EVOLUTION1
+	__GPIO_NCS,
+	__GPIO_PU,
+#endif // __GPIO_EVOLUTION1
+#ifdef __GPIO_EVOLUTION2
+	__GPIO_DR,
+	__GPIO_SR,
+	__GPIO_IE,
+#endif // __GPIO_EVOLUTION2
+#ifdef __GPIO_EVOLUTION3
+	__GPIO_IM1,
+	__GPIO_IM0,
+	__GPIO_INTE,
+	__GPIO_WKUE,
+#endif // __GPIO_EVOLUTION3
+	__GPIO_REGISTER_COUNT,
+} __GpioRegister;
+
+/**
+ * Merged settings of one port. It's a local of gpio_configureAll(), 
+ * which calls no other function, so SDCC can overlay it with the 
+ * locals of other leaf functions instead of reserving RAM for it.
+ */
+typedef struct {
+	unsigned char usedBits[__GPIO_REGISTER_COUNT];
+	unsigned char setBitsValue[__GPIO_REGISTER_COUNT];
+} __GpioMerge;
+
+inline void __gpio_merge(__GpioMerge *merge, __GpioRegister r, unsigned char cfgValue, unsigned char mask) {
+	merge->usedBits[r] |= mask;
+	
+	if (cfgValue) {
+		merge->setBitsValue[r] |= mask;
+	} else {
+		merge->setBitsValue[r] &= ~mask;
+	}
+}
+
+inline unsigned char __gpio_apply(__GpioMerge *merge, unsigned char portValue, __GpioRegister r) {
+	return (portValue & ~merge->usedBits[r]) | merge->setBitsValue[r];
+}
+
+#ifdef __USE_EXTENDED_SFR
+/**
+ * Extended SFRs come in blocks of 8 consecutive registers, one per 
+ * port, so they can be addressed relative to their port 0 instance.
+ */
+inline void __gpio_applyExtended(__GpioMerge *merge, __xdata volatile unsigned char *port0Register, unsigned char port, __GpioRegister r) {
+	if (merge->usedBits[r]) {
+		port0Register[port] = __gpio_apply(merge, port0Register[port], r);
+	}
+}
+#endif // __USE_EXTENDED_SFR
+
+void gpio_configureAll(const GpioConfig __code *configs, unsigned char count) {
+	__GpioMerge merge;
+	
+#ifdef __USE_EXTENDED_SFR
+	enableExtendedSFR();
+#endif // __USE_EXTENDED_SFR
+	
+	for (unsigned char port = 0; port < __GPIO_PORT_COUNT; port++) {
+		unsigned char portBits = 0;
+		
+		for (unsigned char r = 0; r < __GPIO_REGISTER_COUNT; r++) {
+			merge.usedBits[r] = 0;
+			merge.setBitsValue[r] = 0;
+		}
+		
+		// Merge the entries of this port; later entries take precedence.
+		for (unsigned char i = 0; i < count; i++) {
+			const GpioConfig __code *gpioConfig = &configs[i];
+			
+			if (gpioConfig->port != port) {
+				continue;
+			}
+			
+			unsigned char mask = ((unsigned char) ((1 << gpioConfig->count) - 1)) << gpioConfig->pin;
+			portBits |= mask;
+			
+			__gpio_merge(&merge, __GPIO_M1, gpioConfig->portMode & 2, mask);
+			__gpio_merge(&merge, __GPIO_M0, gpioConfig->portMode & 1, mask);
+			
+#ifdef __GPIO_EVOLUTION1
+			__gpio_merge(&merge, __GPIO_NCS, gpioConfig->schmidtTrigger, mask);
+			__gpio_merge(&merge, __GPIO_PU, gpioConfig->internalPullUp, mask);
+#endif // __GPIO_EVOLUTION1
+			
+#ifdef __GPIO_EVOLUTION2
+			if (__isOutput(gpioConfig)) {
+				__gpio_merge(&merge, __GPIO_DR, gpioConfig->currentDrive, mask);
+				__gpio_merge(&merge, __GPIO_SR, gpioConfig->slewRate, mask);
+			}
+			
+			if (__isInput(gpioConfig)) {
+				__gpio_merge(&merge, __GPIO_IE, gpioConfig->digitalInput, mask);
+			}
+#endif // __GPIO_EVOLUTION2
+			
+#ifdef __GPIO_EVOLUTION3
+			__gpio_merge(&merge, __GPIO_IM1, gpioConfig->interruptMode & 2, mask);
+			__gpio_merge(&merge, __GPIO_IM0, gpioConfig->interruptMode & 1, mask);
+			__gpio_merge(&merge, __GPIO_INTE, gpioConfig->interrupts, mask);
+			__gpio_merge(&merge, __GPIO_WKUE, gpioConfig->wakeUp, mask);
+#endif // __GPIO_EVOLUTION3
+		}
+		
+		if (!portBits) {
+			continue;
+		}
+		
+		switch (port) {
+		case GPIO_PORT0:
+			P0M1 = __gpio_apply(&merge, P0M1, __GPIO_M1);
+			P0M0 = __gpio_apply(&merge, P0M0, __GPIO_M0);
+			break;
+		
+		case GPIO_PORT1:
+			P1M1 = __gpio_apply(&merge, P1M1, __GPIO_M1);
+			P1M0 = __gpio_apply(&merge, P1M0, __GPIO_M0);
+			break;
+		
+		case GPIO_PORT2:
+			P2M1 = __gpio_apply(&merge, P2M1, __GPIO_M1);
+			P2M0 = __gpio_apply(&merge, P2M0, __GPIO_M0);
+			break;
+		
+		case GPIO_PORT3:
+			P3M1 = __gpio_apply(&merge, P3M1, __GPIO_M1);
+			P3M0 = __gpio_apply(&merge, P3M0, __GPIO_M0);
+			break;
+		
+		case GPIO_PORT4:
+			P4M1 = __gpio_apply(&merge, P4M1, __GPIO_M1);
+			P4M0 = __gpio_apply(&merge, P4M0, __GPIO_M0);
+			break;
+		
+		case GPIO_PORT5:
+			P5M1 = __gpio_apply(&merge, P5M1, __GPIO_M1);
+			P5M0 = __gpio_apply(&merge, P5M0, __GPIO_M0);
+			break;
+
+#ifdef __GPIO_HAS_PORTS67
+		case GPIO_PORT6:
+			P6M1 = __gpio_apply(&merge, P6M1, __GPIO_M1);
+			P6M0 = __gpio_apply(&merge, P6M0, __GPIO_M0);
+			break;
+		
+		case GPIO_PORT7:
+			P7M1 = __gpio_apply(&merge, P7M1, __GPIO_M1);
+			P7M0 = __gpio_apply(&merge, P7M0, __GPIO_M0);
+			break;
+#endif // __GPIO_HAS_PORTS67
+		}
+		
+#ifdef __GPIO_EVOLUTION1
+		__gpio_applyExtended(&merge, &P0NCS, port, __GPIO_NCS);
+		__gpio_applyExtended(&merge, &P0PU, port, __GPIO_PU);
+#endif // __GPIO_EVOLUTION1
+		
+#ifdef __GPIO_EVOLUTION2
+		__gpio_applyExtended(&merge, &P0DR, port, __GPIO_DR);
+		__gpio_applyExtended(&merge, &P0SR, port, __GPIO_SR);
+		__gpio_applyExtended(&merge, &P0IE, port, __GPIO_IE);
+#endif // __GPIO_EVOLUTION2
+		
+#ifdef __GPIO_EVOLUTION3
+		__gpio_applyExtended(&merge, &P0IM1, port, __GPIO_IM1);
+		__gpio_applyExtended(&merge, &P0IM0, port, __GPIO_IM0);
+		(&P0INTF)[port] &= ~portBits;
+		__gpio_applyExtended(&merge, &P0INTE, port, __GPIO_INTE);
+		__gpio_applyExtended(&merge, &P0WKUE, port, __GPIO_WKUE);
+#endif // __GPIO_EVOLUTION3
+	}
+	
+#ifdef __USE_EXTENDED_SFR
+	disableExtendedSFR();
+#endif // __USE_EXTENDED_SFR
+}
+
 unsigned char gpio_read(GpioConfig *gpioConfig) {
 	unsigned char value = 0;
 	
@@ -186,11 +186,59 @@ typedef struct {
 #define GPIO_PIN_CONFIG(gpioPort, gpioPin, gpioMode) { .port = gpioPort, .pin = gpioPin, .count = 1, .portMode = gpioMode, \
 	DEFAULTS_EVOLUTION1 DEFAULTS_EVOLUTION2 DEFAULTS_EVOLUTION3 }
 
+/**
+ * Compile-time specialised GPIO access.
+ * 
+ * Unlike gpio_read() and gpio_write(), these macros involve neither 
+ * GpioConfig nor any computation at run time: single pins are 
+ * accessed through their SBIT (e.g. GPIO_PIN_SET(3, 7) is a single 
+ * SETB P3_7 instruction), and series of consecutive pins with a 
+ * single read-modify-write of the port.
+ * 
+ * port, pin and count MUST be literal numbers, e.g. GPIO_PIN_SET(3, 7) 
+ * rather than GPIO_PIN_SET(GPIO_PORT3, GPIO_PIN7). The pins must have 
+ * been configured beforehand (e.g. with gpio_configure()).
+ */
+#define GPIO_PIN_SET(port, pin) (P ## port ## _ ## pin = 1)
+#define GPIO_PIN_CLEAR(port, pin) (P ## port ## _ ## pin = 0)
+#define GPIO_PIN_TOGGLE(port, pin) (P ## port ## _ ## pin = !P ## port ## _ ## pin)
+#define GPIO_PIN_WRITE(port, pin, value) (P ## port ## _ ## pin = (value) ? 1 : 0)
+#define GPIO_PIN_READ(port, pin) (P ## port ## _ ## pin)
+
+#define GPIO_FIELD_MASK(pin, count) ((unsigned char) (((1 << (count)) - 1) << (pin)))
+
+/**
+ * Same as gpio_write() and gpio_read() for the series of count pins 
+ * of the given port starting with pin, e.g. GPIO_FIELD_WRITE(1, 4, 4, x) 
+ * writes the 4 least significant bits of x to P1.4 to P1.7.
+ */
+#define GPIO_FIELD_WRITE(port, pin, count, value) (P ## port = (P ## port & ~GPIO_FIELD_MASK(pin, count)) | (((value) << (pin)) & GPIO_FIELD_MASK(pin, count)))
+#define GPIO_FIELD_READ(port, pin, count) ((P ## port & GPIO_FIELD_MASK(pin, count)) >> (pin))
+
 /**
  * Configures a GPIO pin, or series of consecutive pins.
  */
 void gpio_configure(GpioConfig *config);
 
+/**
+ * Configures all GPIO pins described in a table of GpioConfig held 
+ * in code memory, e.g.
+ * 
+ * static const GpioConfig __code pins[] = {
+ * 	GPIO_PORT_CONFIG(GPIO_PORT1, GPIO_PUSH_PULL),
+ * 	GPIO_PIN_CONFIG(GPIO_PORT3, GPIO_PIN2, GPIO_HIGH_IMPEDANCE),
+ * };
+ * 
+ * gpio_configureAll(pins, sizeof(pins) / sizeof(GpioConfig));
+ * 
+ * Entries of the same port are merged (later entries take precedence 
+ * over earlier ones) and each configuration register is written once, 
+ * within a single extended SFR access window. Unlike gpio_configure(), 
+ * no RAM is used per entry: use GPIO_PIN_* macros or a separate 
+ * GpioConfig configured with gpio_configure() to access the pins.
+ */
+void gpio_configureAll(const GpioConfig __code *configs, unsigned char count);
+
 /**
  * Reads a GPIO pin, or series of consecutive pins.
  * 
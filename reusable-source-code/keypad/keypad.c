@@ -0,0 +1,166 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "gpio.h"
+#include "delay.h"
+#include "keypad.h"
+
+/**
+ * @file keypad.c
+ * 
+ * Matrix keypad scanner: implementation.
+ */
+
+#ifndef KEYPAD_DEBOUNCE_MS
+#define KEYPAD_DEBOUNCE_MS 20
+#endif // KEYPAD_DEBOUNCE_MS
+
+#if defined(KEYPAD_WAKE_UP) && !defined(__GPIO_EVOLUTION3)
+#error "KEYPAD_WAKE_UP is only supported by the STC8H family"
+#endif
+
+GpioConfig *__keypad_rows;
+GpioConfig *__keypad_columns;
+
+// All columns pins, in column port bit positions.
+uint8_t __keypad_columnMask;
+
+#ifdef KEYPAD_WAKE_UP
+/**
+ * Enables or disables falling edge interrupts and wake-up on the 
+ * column pins, clearing their pending interrupt flags.
+ */
+void __keypad_enableWakeUp(uint8_t enable) {
+	uint8_t port = __keypad_columns->port;
+	
+	enableExtendedSFR();
+	(&P0INTF)[port] &= ~__keypad_columnMask;
+	
+	if (enable) {
+		(&P0INTE)[port] |= __keypad_columnMask;
+		(&P0WKUE)[port] |= __keypad_columnMask;
+	} else {
+		(&P0INTE)[port] &= ~__keypad_columnMask;
+		(&P0WKUE)[port] &= ~__keypad_columnMask;
+	}
+	
+	disableExtendedSFR();
+}
+#endif // KEYPAD_WAKE_UP
+
+void keypad_initialise(GpioConfig *rows, GpioConfig *columns) {
+	__keypad_rows = rows;
+	__keypad_columns = columns;
+	__keypad_columnMask = GPIO_FIELD_MASK(columns->pin, columns->count);
+	
+#ifdef KEYPAD_WAKE_UP
+	columns->interrupts = GPIO_DISABLED;
+	columns->interruptMode = GPIO_FALLING_EDGE;
+	columns->wakeUp = GPIO_DISABLED;
+#endif // KEYPAD_WAKE_UP
+	
+	gpio_configure(rows);
+	gpio_configure(columns);
+	
+	// Rows are left low so that any key press pulls its column low.
+	gpio_write(rows, 0);
+}
+
+uint8_t keypad_scan() {
+	uint8_t key = KEYPAD_NO_KEY;
+	uint8_t rowCount = __keypad_rows->count;
+	uint8_t columnCount = __keypad_columns->count;
+	
+	for (uint8_t row = 0, first = 1; row < rowCount; row++, first += columnCount) {
+		// Drive this row low, and release the others.
+		gpio_write(__keypad_rows, ~(1 << row));
+		
+		// Give column lines time to settle through the pull-ups.
+		__asm nop __endasm;
+		__asm nop __endasm;
+		
+		uint8_t pressed = ~gpio_read(__keypad_columns);
+		
+		for (uint8_t column = 0; column < columnCount; column++, pressed >>= 1) {
+			if (pressed & 1) {
+				key = first + column;
+				break;
+			}
+		}
+		
+		if (key != KEYPAD_NO_KEY) {
+			break;
+		}
+	}
+	
+	gpio_write(__keypad_rows, 0);
+	
+	return key;
+}
+
+uint8_t keypad_read() {
+	uint8_t key = keypad_scan();
+	
+	for (uint8_t stable = 1; stable < KEYPAD_DEBOUNCE_MS; ) {
+		delay1ms(1);
+		uint8_t next = keypad_scan();
+		
+		if (next == key) {
+			stable++;
+		} else {
+			key = next;
+			stable = 1;
+		}
+	}
+	
+	return key;
+}
+
+#ifdef KEYPAD_WAKE_UP
+uint8_t keypad_sleepUntilPressed() {
+	// Wait for the key reported last time (if any) to be released, 
+	// so a key held down is only reported once.
+	while (keypad_read() != KEYPAD_NO_KEY);
+	
+	__keypad_enableWakeUp(1);
+	
+	// A key pressed since would produce no falling edge to wake us up.
+	if (gpio_read(__keypad_columns) == GPIO_FIELD_MASK(0, __keypad_columns->count)) {
+		PCON |= PD;
+		__asm nop __endasm;
+		__asm nop __endasm;
+	}
+	
+	// Scanning changes column levels: no need for interrupts now.
+	__keypad_enableWakeUp(0);
+	
+	return keypad_read();
+}
+#endif // KEYPAD_WAKE_UP
@@ -0,0 +1,98 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _KEYPAD_H
+#define _KEYPAD_H
+
+#include <stdint.h>
+
+/**
+ * @file keypad.h
+ * 
+ * Matrix keypad scanner: definitions.
+ * 
+ * Rows are driven low one at a time, and columns (with pull-up 
+ * resistors) are read back to find which key connects them. Both are 
+ * described by GpioConfig ranges of up to 8 consecutive pins.
+ * 
+ * On the STC8H, defining KEYPAD_WAKE_UP in project-defs.h adds 
+ * keypad_sleepUntilPressed(), which powers the MCU down until a key 
+ * is pressed.
+ * 
+ * Supported MCU families: STC12, STC15, STC8A, STC8F, STC8G, STC8H.
+ */
+
+/**
+ * Value returned when no key is pressed.
+ */
+#define KEYPAD_NO_KEY 0
+
+/**
+ * Configures the row and column pins, and leaves all rows driven low. 
+ * .portMode of rows should be GPIO_OPEN_DRAIN or GPIO_BIDIRECTIONAL, 
+ * and that of columns GPIO_BIDIRECTIONAL or GPIO_HIGH_IMPEDANCE with 
+ * pull-up resistors. Other settings are taken as is, except that 
+ * interrupts are enabled on columns when needed by 
+ * keypad_sleepUntilPressed().
+ * 
+ * Both structures must remain valid as long as the keypad is used.
+ */
+void keypad_initialise(GpioConfig *rows, GpioConfig *columns);
+
+/**
+ * Scans the keypad once.
+ * 
+ * @returns KEYPAD_NO_KEY, or the number of the first key found 
+ * pressed: 1 + row * number of columns + column.
+ */
+uint8_t keypad_scan();
+
+/**
+ * Scans the keypad every millisecond until the result stays the same 
+ * for KEYPAD_DEBOUNCE_MS milliseconds (20 by default).
+ * 
+ * @returns the same as keypad_scan().
+ */
+uint8_t keypad_read();
+
+#ifdef KEYPAD_WAKE_UP
+/**
+ * Waits until all keys are released, powers the MCU down until a key 
+ * is pressed, then returns the debounced key number (see 
+ * keypad_read()), which is KEYPAD_NO_KEY for a glitch or a key 
+ * released too early. A key held down is thus only reported once.
+ * 
+ * The column port's interrupts must be handled by ../gpio/gpio-interrupts.c 
+ * (i.e. GPIO_USE_PORTn_INTERRUPTS must be defined for it), and 
+ * interrupts enabled (EA = 1).
+ */
+uint8_t keypad_sleepUntilPressed();
+#endif // KEYPAD_WAKE_UP
+
+#endif // _KEYPAD_H
@@ -0,0 +1,226 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "display.h"
+
+/**
+ * @file display.c
+ * 
+ * Multiplexed LED / 7-segment display refreshed by a timer interrupt: 
+ * implementation.
+ */
+
+#if !defined(DISPLAY_SEGMENT_PORT) || !defined(DISPLAY_DIGIT_PORT)
+#error "DISPLAY_SEGMENT_PORT and DISPLAY_DIGIT_PORT must be defined in project-defs.h"
+#endif
+
+#ifndef DISPLAY_DIGITS
+#define DISPLAY_DIGITS 8
+#endif // DISPLAY_DIGITS
+
+#if DISPLAY_DIGITS < 1 || DISPLAY_DIGITS > 8
+#error "DISPLAY_DIGITS must be between 1 and 8"
+#endif
+
+#ifndef DISPLAY_REFRESH_HZ
+#define DISPLAY_REFRESH_HZ 100
+#endif // DISPLAY_REFRESH_HZ
+
+// Common anode displays light segments driven low.
+#ifdef DISPLAY_SEGMENTS_ACTIVE_LOW
+#define __DISPLAY_SEGMENTS_OFF 0xff
+#else
+#define __DISPLAY_SEGMENTS_OFF 0x00
+#endif // DISPLAY_SEGMENTS_ACTIVE_LOW
+
+#ifdef DISPLAY_DIGITS_ACTIVE_LOW
+#define __DISPLAY_DIGITS_OFF 0xff
+#else
+#define __DISPLAY_DIGITS_OFF 0x00
+#endif // DISPLAY_DIGITS_ACTIVE_LOW
+
+// Pins of DISPLAY_DIGIT_PORT used to select digits.
+#define __DISPLAY_DIGIT_MASK ((uint8_t) ((1 << DISPLAY_DIGITS) - 1))
+
+// Timers count at SYSclk/12, except on an STC90 in 6T mode where 
+// they count at SYSclk/6.
+#ifdef _STC90_H
+#define __DISPLAY_TIMER_DIVIDER T_CPU
+#else
+#define __DISPLAY_TIMER_DIVIDER 12UL
+#endif // _STC90_H
+
+// Each digit has a time slot of __DISPLAY_SLOT_COUNTS timer counts.
+#define __DISPLAY_SLOT_COUNTS ((F_CPU / __DISPLAY_TIMER_DIVIDER + DISPLAY_REFRESH_HZ * DISPLAY_DIGITS / 2) / (DISPLAY_REFRESH_HZ * DISPLAY_DIGITS))
+
+#if __DISPLAY_SLOT_COUNTS > 65536UL
+#error "DISPLAY_REFRESH_HZ is too low for F_CPU"
+#endif
+
+#if __DISPLAY_SLOT_COUNTS < 4 * DISPLAY_MAX_BRIGHTNESS
+#error "DISPLAY_REFRESH_HZ is too high for F_CPU"
+#endif
+
+#if DISPLAY_TIMER == 0
+#define __DISPLAY_TL TL0
+#define __DISPLAY_TH TH0
+#define __DISPLAY_TR TR0
+#define __DISPLAY_TF TF0
+#define __DISPLAY_ET ET0
+#define __DISPLAY_TMOD_MASK 0xF0
+#define __DISPLAY_TMOD T0_M0
+#define __DISPLAY_INTERRUPT TIMER0_INTERRUPT
+#define __DISPLAY_X12 T0x12
+#elif DISPLAY_TIMER == 1
+#define __DISPLAY_TL TL1
+#define __DISPLAY_TH TH1
+#define __DISPLAY_TR TR1
+#define __DISPLAY_TF TF1
+#define __DISPLAY_ET ET1
+#define __DISPLAY_TMOD_MASK 0x0F
+#define __DISPLAY_TMOD T1_M0
+#define __DISPLAY_INTERRUPT TIMER1_INTERRUPT
+#define __DISPLAY_X12 T1x12
+#else
+#error "DISPLAY_TIMER must be 0 or 1"
+#endif // DISPLAY_TIMER
+
+static const uint8_t __code __display_hexDigits[] = {
+	0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07, 
+	0x7f, 0x6f, 0x77, 0x7c, 0x39, 0x5e, 0x79, 0x71, 
+};
+
+// Value of the digit selection pins for each digit.
+static const uint8_t __code __display_digitSelect[] = {
+	0x01 ^ __DISPLAY_DIGITS_OFF, 0x02 ^ __DISPLAY_DIGITS_OFF, 
+	0x04 ^ __DISPLAY_DIGITS_OFF, 0x08 ^ __DISPLAY_DIGITS_OFF, 
+	0x10 ^ __DISPLAY_DIGITS_OFF, 0x20 ^ __DISPLAY_DIGITS_OFF, 
+	0x40 ^ __DISPLAY_DIGITS_OFF, 0x80 ^ __DISPLAY_DIGITS_OFF, 
+};
+
+// Port values of the segments of each digit.
+__data uint8_t __display_buffer[DISPLAY_DIGITS];
+
+// Digit currently lit.
+uint8_t __display_digit;
+
+// Timer reload values for the lit and blanked parts of a time slot. 
+// __display_offReload is 0 at full brightness.
+volatile uint16_t __display_onReload;
+volatile uint16_t __display_offReload;
+
+// Set while the current digit is lit.
+char __display_lit;
+
+inline void __display_reload(uint16_t value) {
+	__DISPLAY_TL = (uint8_t) (value & 0xff);
+	__DISPLAY_TH = (uint8_t) (value >> 8);
+}
+
+void __display_timer_isr() __interrupt __DISPLAY_INTERRUPT __using 1 __critical {
+	if (__display_lit && __display_offReload) {
+		// End of the lit part of the time slot.
+		DISPLAY_SEGMENT_PORT = __DISPLAY_SEGMENTS_OFF;
+		__display_reload(__display_offReload);
+		__display_lit = 0;
+	} else {
+		__display_digit++;
+		
+		if (__display_digit == DISPLAY_DIGITS) {
+			__display_digit = 0;
+		}
+		
+		// Blank segments while switching digits to avoid ghosting.
+		DISPLAY_SEGMENT_PORT = __DISPLAY_SEGMENTS_OFF;
+		DISPLAY_DIGIT_PORT = (DISPLAY_DIGIT_PORT & ~__DISPLAY_DIGIT_MASK) | (__display_digitSelect[__display_digit] & __DISPLAY_DIGIT_MASK);
+		DISPLAY_SEGMENT_PORT = __display_buffer[__display_digit];
+		__display_reload(__display_onReload);
+		__display_lit = 1;
+	}
+}
+
+void display_initialise() {
+	display_clear();
+	__display_digit = 0;
+	__display_lit = 0;
+	
+	// Timer in mode 1 (16-bit, no auto-reload), in 12T mode.
+	__DISPLAY_TR = 0;
+	TMOD = (TMOD & __DISPLAY_TMOD_MASK) | __DISPLAY_TMOD;
+#ifndef _STC90_H
+	AUXR &= ~__DISPLAY_X12;
+#endif // _STC90_H
+	__DISPLAY_TF = 0;
+	__DISPLAY_ET = 1;
+	
+	display_setBrightness(DISPLAY_MAX_BRIGHTNESS);
+}
+
+void display_setBrightness(uint8_t level) {
+	if (level == 0) {
+		__DISPLAY_TR = 0;
+		DISPLAY_SEGMENT_PORT = __DISPLAY_SEGMENTS_OFF;
+		return;
+	}
+	
+	if (level > DISPLAY_MAX_BRIGHTNESS) {
+		level = DISPLAY_MAX_BRIGHTNESS;
+	}
+	
+	uint16_t onCounts = (uint16_t) (__DISPLAY_SLOT_COUNTS / DISPLAY_MAX_BRIGHTNESS) * level;
+	uint16_t onReload = (uint16_t) (65536UL - onCounts);
+	uint16_t offReload = (level == DISPLAY_MAX_BRIGHTNESS) ? 0 : (uint16_t) (65536UL - __DISPLAY_SLOT_COUNTS + onCounts);
+	
+	__DISPLAY_ET = 0;
+	__display_onReload = onReload;
+	__display_offReload = offReload;
+	__DISPLAY_ET = 1;
+	
+	if (!__DISPLAY_TR) {
+		__display_reload(onReload);
+		__DISPLAY_TR = 1;
+	}
+}
+
+void display_setDigit(uint8_t position, uint8_t value, uint8_t dp) {
+	display_setSegments(position, __display_hexDigits[value & 0x0f] | (dp ? DISPLAY_SEGMENT_DP : 0));
+}
+
+void display_setSegments(uint8_t position, uint8_t segments) {
+	if (position < DISPLAY_DIGITS) {
+		__display_buffer[position] = segments ^ __DISPLAY_SEGMENTS_OFF;
+	}
+}
+
+void display_clear() {
+	for (uint8_t i = 0; i < DISPLAY_DIGITS; i++) {
+		__display_buffer[i] = __DISPLAY_SEGMENTS_OFF;
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _DISPLAY_H
+#define _DISPLAY_H
+
+#include <stdint.h>
+
+/**
+ * @file display.h
+ * 
+ * Multiplexed LED / 7-segment display refreshed by a timer interrupt: 
+ * definitions.
+ * 
+ * Segments a to g and the decimal point are driven by bits 0 to 7 
+ * of DISPLAY_SEGMENT_PORT, and digit n is selected by bit n of 
+ * DISPLAY_DIGIT_PORT. Each timer interrupt lights the next digit, 
+ * and brightness is controlled by blanking the display for part of 
+ * each digit's time slot.
+ * 
+ * Supported MCU families: STC90, STC12, STC15, STC8A/F/G/H.
+ */
+
+#define DISPLAY_SEGMENT_DP 0x80
+#define DISPLAY_BLANK 0x00
+#define DISPLAY_MINUS 0x40
+
+/**
+ * Highest brightness level, see display_setBrightness().
+ */
+#define DISPLAY_MAX_BRIGHTNESS 16
+
+/**
+ * Blanks all digits and starts refreshing the display at full 
+ * brightness.
+ */
+void display_initialise();
+
+/**
+ * Sets the brightness of the display, from 0 (off) to 
+ * DISPLAY_MAX_BRIGHTNESS.
+ */
+void display_setBrightness(uint8_t level);
+
+/**
+ * Shows a hexadecimal digit (0 to 15) at the given position, 0 being 
+ * the digit selected by bit 0 of DISPLAY_DIGIT_PORT. Non-zero dp 
+ * lights the decimal point.
+ */
+void display_setDigit(uint8_t position, uint8_t value, uint8_t dp);
+
+/**
+ * Lights the given segments (bit 0 = a ... bit 6 = g, bit 7 = DP) 
+ * at the given position, e.g. DISPLAY_MINUS.
+ */
+void display_setSegments(uint8_t position, uint8_t segments);
+
+/**
+ * Blanks all digits.
+ */
+void display_clear();
+
+#ifndef DISPLAY_TIMER
+#define DISPLAY_TIMER 0
+#endif // DISPLAY_TIMER
+
+#if DISPLAY_TIMER == 0
+void __display_timer_isr() __interrupt TIMER0_INTERRUPT __using 1;
+#else
+void __display_timer_isr() __interrupt TIMER1_INTERRUPT __using 1;
+#endif // DISPLAY_TIMER
+
+#endif // _DISPLAY_H
@@ -0,0 +1,439 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "console.h"
+#include "modbus.h"
+
+/**
+ * @file modbus.c
+ * 
+ * Modbus RTU slave running on the serial console: implementation.
+ * 
+ * Frame boundaries are detected by the console driver (silences 
+ * timed by Timer 0), so we get one complete request at a time.
+ */
+
+#ifndef CONSOLE_FRAME_TIMEOUT
+#error "The Modbus slave requires CONSOLE_FRAME_TIMEOUT to be defined (e.g. 35)"
+#endif
+
+#ifndef MODBUS_BUFFER_SPACE
+#define MODBUS_BUFFER_SPACE __xdata
+#endif
+
+#define MODBUS_BROADCAST_ADDRESS 0
+
+#define MODBUS_READ_COILS 1
+#define MODBUS_READ_DISCRETE_INPUTS 2
+#define MODBUS_READ_HOLDING_REGISTERS 3
+#define MODBUS_READ_INPUT_REGISTERS 4
+#define MODBUS_WRITE_SINGLE_COIL 5
+#define MODBUS_WRITE_SINGLE_REGISTER 6
+#define MODBUS_WRITE_MULTIPLE_COILS 15
+#define MODBUS_WRITE_MULTIPLE_REGISTERS 16
+
+#define MODBUS_ILLEGAL_FUNCTION 1
+#define MODBUS_ILLEGAL_DATA_ADDRESS 2
+#define MODBUS_ILLEGAL_DATA_VALUE 3
+
+// Modbus RTU frames can be 256 bytes long, but the console buffers 
+// can't hold more than 255, which is enough for all the responses 
+// we send (e.g. 125 registers read).
+#define MODBUS_MAX_FRAME_LENGTH 255
+
+// Request, then response.
+MODBUS_BUFFER_SPACE uint8_t __modbus_frame[MODBUS_MAX_FRAME_LENGTH];
+// Length of the request, then of the response (without CRC).
+uint8_t __modbus_length;
+
+uint8_t __modbus_address;
+ModbusTables *__modbus_tables;
+
+/*
+ * CRC-16 lookup tables (polynomial 0xA001, reflected), split in low 
+ * and high bytes so the CRC can be updated with 8-bit operations only.
+ */
+__code uint8_t __modbus_crcLow[] = {
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41,
+	0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40,
+};
+
+__code uint8_t __modbus_crcHigh[] = {
+	0x00, 0xC0, 0xC1, 0x01, 0xC3, 0x03, 0x02, 0xC2,
+	0xC6, 0x06, 0x07, 0xC7, 0x05, 0xC5, 0xC4, 0x04,
+	0xCC, 0x0C, 0x0D, 0xCD, 0x0F, 0xCF, 0xCE, 0x0E,
+	0x0A, 0xCA, 0xCB, 0x0B, 0xC9, 0x09, 0x08, 0xC8,
+	0xD8, 0x18, 0x19, 0xD9, 0x1B, 0xDB, 0xDA, 0x1A,
+	0x1E, 0xDE, 0xDF, 0x1F, 0xDD, 0x1D, 0x1C, 0xDC,
+	0x14, 0xD4, 0xD5, 0x15, 0xD7, 0x17, 0x16, 0xD6,
+	0xD2, 0x12, 0x13, 0xD3, 0x11, 0xD1, 0xD0, 0x10,
+	0xF0, 0x30, 0x31, 0xF1, 0x33, 0xF3, 0xF2, 0x32,
+	0x36, 0xF6, 0xF7, 0x37, 0xF5, 0x35, 0x34, 0xF4,
+	0x3C, 0xFC, 0xFD, 0x3D, 0xFF, 0x3F, 0x3E, 0xFE,
+	0xFA, 0x3A, 0x3B, 0xFB, 0x39, 0xF9, 0xF8, 0x38,
+	0x28, 0xE8, 0xE9, 0x29, 0xEB, 0x2B, 0x2A, 0xEA,
+	0xEE, 0x2E, 0x2F, 0xEF, 0x2D, 0xED, 0xEC, 0x2C,
+	0xE4, 0x24, 0x25, 0xE5, 0x27, 0xE7, 0xE6, 0x26,
+	0x22, 0xE2, 0xE3, 0x23, 0xE1, 0x21, 0x20, 0xE0,
+	0xA0, 0x60, 0x61, 0xA1, 0x63, 0xA3, 0xA2, 0x62,
+	0x66, 0xA6, 0xA7, 0x67, 0xA5, 0x65, 0x64, 0xA4,
+	0x6C, 0xAC, 0xAD, 0x6D, 0xAF, 0x6F, 0x6E, 0xAE,
+	0xAA, 0x6A, 0x6B, 0xAB, 0x69, 0xA9, 0xA8, 0x68,
+	0x78, 0xB8, 0xB9, 0x79, 0xBB, 0x7B, 0x7A, 0xBA,
+	0xBE, 0x7E, 0x7F, 0xBF, 0x7D, 0xBD, 0xBC, 0x7C,
+	0xB4, 0x74, 0x75, 0xB5, 0x77, 0xB7, 0xB6, 0x76,
+	0x72, 0xB2, 0xB3, 0x73, 0xB1, 0x71, 0x70, 0xB0,
+	0x50, 0x90, 0x91, 0x51, 0x93, 0x53, 0x52, 0x92,
+	0x96, 0x56, 0x57, 0x97, 0x55, 0x95, 0x94, 0x54,
+	0x9C, 0x5C, 0x5D, 0x9D, 0x5F, 0x9F, 0x9E, 0x5E,
+	0x5A, 0x9A, 0x9B, 0x5B, 0x99, 0x59, 0x58, 0x98,
+	0x88, 0x48, 0x49, 0x89, 0x4B, 0x8B, 0x8A, 0x4A,
+	0x4E, 0x8E, 0x8F, 0x4F, 0x8D, 0x4D, 0x4C, 0x8C,
+	0x44, 0x84, 0x85, 0x45, 0x87, 0x47, 0x46, 0x86,
+	0x82, 0x42, 0x43, 0x83, 0x41, 0x81, 0x80, 0x40,
+};
+
+uint16_t modbus_crc(const uint8_t *data, uint16_t length) {
+	uint8_t low = 0xFF;
+	uint8_t high = 0xFF;
+	
+	while (length--) {
+		uint8_t index = low ^ *data++;
+		low = high ^ __modbus_crcLow[index];
+		high = __modbus_crcHigh[index];
+	}
+	
+	return ((uint16_t) high << 8) | low;
+}
+
+void modbus_initialise(uint8_t address, ModbusTables *tables) {
+	__modbus_address = address;
+	__modbus_tables = tables;
+}
+
+/*
+ * @returns the big-endian 16-bit value at the given offset of 
+ * the frame.
+ */
+uint16_t __modbus_word(uint8_t offset) {
+	return ((uint16_t) __modbus_frame[offset] << 8) | __modbus_frame[offset + 1];
+}
+
+/*
+ * Reads coils or discrete inputs.
+ * 
+ * @returns an exception code, or 0 if successful.
+ */
+uint8_t __modbus_readBits(uint8_t *table, uint16_t count) {
+	uint16_t start = __modbus_word(2);
+	uint16_t quantity = __modbus_word(4);
+	
+	if (__modbus_length != 6 || quantity == 0 || quantity > 2000) {
+		return MODBUS_ILLEGAL_DATA_VALUE;
+	}
+	
+	if (quantity > count || start > count - quantity) {
+		return MODBUS_ILLEGAL_DATA_ADDRESS;
+	}
+	
+	uint8_t byteCount = (quantity + 7) >> 3;
+	__modbus_frame[2] = byteCount;
+	__modbus_length = 3 + byteCount;
+	
+	for (uint8_t i = 0; i < byteCount; i++) {
+		__modbus_frame[3 + i] = 0;
+	}
+	
+	for (uint16_t i = 0; i < quantity; i++, start++) {
+		if (table[start >> 3] & (1 << (start & 7))) {
+			__modbus_frame[3 + (i >> 3)] |= 1 << (i & 7);
+		}
+	}
+	
+	return 0;
+}
+
+/*
+ * Reads holding or input registers.
+ * 
+ * @returns an exception code, or 0 if successful.
+ */
+uint8_t __modbus_readRegisters(uint16_t *table, uint16_t count) {
+	uint16_t start = __modbus_word(2);
+	uint16_t quantity = __modbus_word(4);
+	
+	if (__modbus_length != 6 || quantity == 0 || quantity > 125) {
+		return MODBUS_ILLEGAL_DATA_VALUE;
+	}
+	
+	if (quantity > count || start > count - quantity) {
+		return MODBUS_ILLEGAL_DATA_ADDRESS;
+	}
+	
+	uint8_t *out = &__modbus_frame[3];
+	uint16_t *in = &table[start];
+	
+	__modbus_frame[2] = quantity << 1;
+	__modbus_length = 3 + (quantity << 1);
+	
+	while (quantity--) {
+		uint16_t value = *in++;
+		*out++ = value >> 8;
+		*out++ = value & 0xFF;
+	}
+	
+	return 0;
+}
+
+/*
+ * Writes a single coil. The response is the request itself.
+ * 
+ * @returns an exception code, or 0 if successful.
+ */
+uint8_t __modbus_writeSingleCoil() {
+	uint16_t address = __modbus_word(2);
+	uint16_t value = __modbus_word(4);
+	
+	if (__modbus_length != 6 || (value != 0xFF00 && value != 0x0000)) {
+		return MODBUS_ILLEGAL_DATA_VALUE;
+	}
+	
+	if (address >= __modbus_tables->coilCount) {
+		return MODBUS_ILLEGAL_DATA_ADDRESS;
+	}
+	
+	if (value) {
+		__modbus_tables->coils[address >> 3] |= 1 << (address & 7);
+	} else {
+		__modbus_tables->coils[address >> 3] &= ~(1 << (address & 7));
+	}
+	
+	__modbus_length = 6;
+	
+	return 0;
+}
+
+/*
+ * Writes a single holding register. The response is the request 
+ * itself.
+ * 
+ * @returns an exception code, or 0 if successful.
+ */
+uint8_t __modbus_writeSingleRegister() {
+	uint16_t address = __modbus_word(2);
+	
+	if (__modbus_length != 6) {
+		return MODBUS_ILLEGAL_DATA_VALUE;
+	}
+	
+	if (address >= __modbus_tables->holdingRegisterCount) {
+		return MODBUS_ILLEGAL_DATA_ADDRESS;
+	}
+	
+	__modbus_tables->holdingRegisters[address] = __modbus_word(4);
+	__modbus_length = 6;
+	
+	return 0;
+}
+
+/*
+ * Writes multiple coils. The response is the beginning of the 
+ * request (address, function, start and quantity).
+ * 
+ * @returns an exception code, or 0 if successful.
+ */
+uint8_t __modbus_writeMultipleCoils() {
+	uint16_t start = __modbus_word(2);
+	uint16_t quantity = __modbus_word(4);
+	uint8_t byteCount = __modbus_frame[6];
+	uint16_t count = __modbus_tables->coilCount;
+	
+	if (quantity == 0 || quantity > 1968 || byteCount != ((quantity + 7) >> 3) || __modbus_length != 7 + byteCount) {
+		return MODBUS_ILLEGAL_DATA_VALUE;
+	}
+	
+	if (quantity > count || start > count - quantity) {
+		return MODBUS_ILLEGAL_DATA_ADDRESS;
+	}
+	
+	uint8_t *coils = __modbus_tables->coils;
+	
+	for (uint16_t i = 0; i < quantity; i++, start++) {
+		if (__modbus_frame[7 + (i >> 3)] & (1 << (i & 7))) {
+			coils[start >> 3] |= 1 << (start & 7);
+		} else {
+			coils[start >> 3] &= ~(1 << (start & 7));
+		}
+	}
+	
+	__modbus_length = 6;
+	
+	return 0;
+}
+
+/*
+ * Writes multiple holding registers. The response is the beginning 
+ * of the request (address, function, start and quantity).
+ * 
+ * @returns an exception code, or 0 if successful.
+ */
+uint8_t __modbus_writeMultipleRegisters() {
+	uint16_t start = __modbus_word(2);
+	uint16_t quantity = __modbus_word(4);
+	uint8_t byteCount = __modbus_frame[6];
+	uint16_t count = __modbus_tables->holdingRegisterCount;
+	
+	if (quantity == 0 || quantity > 123 || byteCount != (quantity << 1) || __modbus_length != 7 + byteCount) {
+		return MODBUS_ILLEGAL_DATA_VALUE;
+	}
+	
+	if (quantity > count || start > count - quantity) {
+		return MODBUS_ILLEGAL_DATA_ADDRESS;
+	}
+	
+	uint8_t *in = &__modbus_frame[7];
+	uint16_t *out = &__modbus_tables->holdingRegisters[start];
+	
+	while (quantity--) {
+		*out++ = ((uint16_t) in[0] << 8) | in[1];
+		in += 2;
+	}
+	
+	__modbus_length = 6;
+	
+	return 0;
+}
+
+uint8_t modbus_poll() {
+	__modbus_length = console_readFrame(__modbus_frame, MODBUS_MAX_FRAME_LENGTH);
+	
+	// Ignore empty, truncated or corrupted frames, as well as 
+	// requests for other slaves. The CRC of a valid frame, 
+	// including its own CRC, is 0.
+	if (__modbus_length < 4 || modbus_crc(__modbus_frame, __modbus_length)) {
+		return 0;
+	}
+	
+	uint8_t address = __modbus_frame[0];
+	uint8_t function = __modbus_frame[1];
+	uint8_t exception;
+	
+	if (address != __modbus_address && address != MODBUS_BROADCAST_ADDRESS) {
+		return 0;
+	}
+	
+	// Exclude the CRC.
+	__modbus_length -= 2;
+	
+	switch (function) {
+	case MODBUS_READ_COILS:
+		exception = __modbus_readBits(__modbus_tables->coils, __modbus_tables->coilCount);
+		break;
+	
+	case MODBUS_READ_DISCRETE_INPUTS:
+		exception = __modbus_readBits(__modbus_tables->discreteInputs, __modbus_tables->discreteInputCount);
+		break;
+	
+	case MODBUS_READ_HOLDING_REGISTERS:
+		exception = __modbus_readRegisters(__modbus_tables->holdingRegisters, __modbus_tables->holdingRegisterCount);
+		break;
+	
+	case MODBUS_READ_INPUT_REGISTERS:
+		exception = __modbus_readRegisters(__modbus_tables->inputRegisters, __modbus_tables->inputRegisterCount);
+		break;
+	
+	case MODBUS_WRITE_SINGLE_COIL:
+		exception = __modbus_writeSingleCoil();
+		break;
+	
+	case MODBUS_WRITE_SINGLE_REGISTER:
+		exception = __modbus_writeSingleRegister();
+		break;
+	
+	case MODBUS_WRITE_MULTIPLE_COILS:
+		exception = __modbus_writeMultipleCoils();
+		break;
+	
+	case MODBUS_WRITE_MULTIPLE_REGISTERS:
+		exception = __modbus_writeMultipleRegisters();
+		break;
+	
+	default:
+		exception = MODBUS_ILLEGAL_FUNCTION;
+		break;
+	}
+	
+	// Broadcast requests are never answered.
+	if (address != MODBUS_BROADCAST_ADDRESS) {
+		if (exception) {
+			__modbus_frame[1] = function | 0x80;
+			__modbus_frame[2] = exception;
+			__modbus_length = 3;
+		}
+		
+		uint16_t crc = modbus_crc(__modbus_frame, __modbus_length);
+		__modbus_frame[__modbus_length++] = crc & 0xFF;
+		__modbus_frame[__modbus_length++] = crc >> 8;
+		
+		console_write(__modbus_frame, __modbus_length);
+	}
+	
+	return exception ? 0 : function;
+}
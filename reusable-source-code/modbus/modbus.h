@@ -0,0 +1,87 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _MODBUS_H
+#define _MODBUS_H
+
+#include <stdint.h>
+
+/**
+ * @file modbus.h
+ * 
+ * Modbus RTU slave running on the serial console: definitions.
+ */
+
+/**
+ * Data the application exposes to the Modbus master. Coils and 
+ * discrete inputs are packed 8 per byte, coil 0 being bit 0 of 
+ * the first byte. Tables the application doesn't use must have 
+ * a count of 0.
+ */
+typedef struct {
+	uint8_t *coils;					/*!< Read/write bits. */
+	uint16_t coilCount;
+	uint8_t *discreteInputs;		/*!< Read-only bits. */
+	uint16_t discreteInputCount;
+	uint16_t *holdingRegisters;		/*!< Read/write registers. */
+	uint16_t holdingRegisterCount;
+	uint16_t *inputRegisters;		/*!< Read-only registers. */
+	uint16_t inputRegisterCount;
+} ModbusTables;
+
+/**
+ * Initialises the Modbus slave, which will answer requests sent to 
+ * the given address (1 to 247) using the given tables.
+ * 
+ * The serial console must be initialised separately, with frame 
+ * detection enabled (see HOW-TO-USE).
+ */
+void modbus_initialise(uint8_t address, ModbusTables *tables);
+
+/**
+ * Handles the next complete request received, if any, and sends 
+ * the response. Doesn't wait for requests to be received.
+ * 
+ * Supported functions are 1 (read coils), 2 (read discrete inputs), 
+ * 3 (read holding registers), 4 (read input registers), 5 (write 
+ * single coil), 6 (write single register), 15 (write multiple coils) 
+ * and 16 (write multiple registers).
+ * 
+ * @returns the function code of the request handled successfully, 
+ * so the application can take written values into account, 
+ * or 0 if there was none.
+ */
+uint8_t modbus_poll();
+
+/**
+ * @returns the Modbus CRC-16 of the given data.
+ */
+uint16_t modbus_crc(const uint8_t *data, uint16_t length);
+
+#endif // _MODBUS_H
@@ -0,0 +1,217 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdarg.h>
+#include "project-defs.h"
+#include "console.h"
+#include "console-printf.h"
+
+/**
+ * @file console-printf.c
+ * 
+ * Compact formatted output to the serial console: implementation.
+ * 
+ * Numbers are converted without any division (which would pull 
+ * SDCC's 16-bit division helper in), and output is written to the 
+ * console in blocks rather than one character at a time.
+ */
+
+#ifndef CONSOLE_PRINTF_CHUNK_SIZE
+#define CONSOLE_PRINTF_CHUNK_SIZE 16
+#endif
+
+unsigned char __console_printfChunk[CONSOLE_PRINTF_CHUNK_SIZE];
+unsigned char __console_printfLength;
+
+// Digits of the number being formatted (at most 5 for 16-bit values).
+char __console_printfDigits[5];
+
+__code unsigned int __console_powersOf10[] = { 10000, 1000, 100, 10, 1 };
+__code char __console_hexDigits[] = "0123456789abcdef";
+
+void __console_printfCharacter(char c) {
+	__console_printfChunk[__console_printfLength++] = c;
+	
+	if (__console_printfLength == CONSOLE_PRINTF_CHUNK_SIZE) {
+		console_write(__console_printfChunk, CONSOLE_PRINTF_CHUNK_SIZE);
+		__console_printfLength = 0;
+	}
+}
+
+/*
+ * Converts the given value to decimal digits, by repeated 
+ * subtraction of powers of 10.
+ * 
+ * @returns the number of digits.
+ */
+unsigned char __console_printfDecimal(unsigned int value) {
+	unsigned char count = 0;
+	
+	for (unsigned char i = 0; i < 5; i++) {
+		unsigned int power = __console_powersOf10[i];
+		char digit = '0';
+		
+		while (value >= power) {
+			value -= power;
+			digit++;
+		}
+		
+		// Skip leading zeroes, but keep the last digit.
+		if (digit != '0' || count || i == 4) {
+			__console_printfDigits[count++] = digit;
+		}
+	}
+	
+	return count;
+}
+
+/*
+ * Converts the given value to hexadecimal digits.
+ * 
+ * @returns the number of digits.
+ */
+unsigned char __console_printfHexadecimal(unsigned int value) {
+	unsigned char count = 0;
+	
+	for (unsigned char shift = 12; ; shift -= 4) {
+		unsigned char nibble = (value >> shift) & 0x0F;
+		
+		if (nibble || count || !shift) {
+			__console_printfDigits[count++] = __console_hexDigits[nibble];
+		}
+		
+		if (!shift) {
+			return count;
+		}
+	}
+}
+
+void console_printf(const char *format, ...) {
+	va_list args;
+	char c;
+	
+	va_start(args, format);
+	__console_printfLength = 0;
+	
+	while ((c = *format++)) {
+		if (c != '%') {
+			__console_printfCharacter(c);
+			continue;
+		}
+		
+		char pad = ' ';
+		unsigned char width = 0;
+		c = *format++;
+		
+		if (c == '0') {
+			pad = '0';
+			c = *format++;
+		}
+		
+		while (c >= '0' && c <= '9') {
+			width = width * 10 + (c - '0');
+			c = *format++;
+		}
+		
+		if (!c) {
+			break;
+		}
+		
+		const char *text = __console_printfDigits;
+		unsigned char length;
+		char sign = 0;
+		
+		switch (c) {
+		case 'd':
+			{
+				int value = va_arg(args, int);
+				
+				if (value < 0) {
+					sign = '-';
+					value = -value;
+				}
+				
+				length = __console_printfDecimal((unsigned int) value);
+			}
+			break;
+			
+		case 'u':
+			length = __console_printfDecimal(va_arg(args, unsigned int));
+			break;
+			
+		case 'x':
+			length = __console_printfHexadecimal(va_arg(args, unsigned int));
+			break;
+			
+		case 's':
+			text = va_arg(args, const char *);
+			
+			for (length = 0; text[length]; length++);
+			break;
+			
+		case 'c':
+			__console_printfDigits[0] = (char) va_arg(args, int);
+			length = 1;
+			break;
+			
+		default:
+			// Unknown conversion, or %%: output it as is.
+			__console_printfDigits[0] = c;
+			length = 1;
+			break;
+		}
+		
+		unsigned char padding = sign ? 1 : 0;
+		padding = width > length + padding ? width - length - padding : 0;
+		
+		if (sign && pad == '0') {
+			// Zeroes go between the sign and the digits.
+			__console_printfCharacter(sign);
+			sign = 0;
+		}
+		
+		while (padding--) {
+			__console_printfCharacter(pad);
+		}
+		
+		if (sign) {
+			__console_printfCharacter(sign);
+		}
+		
+		while (length--) {
+			__console_printfCharacter(*text++);
+		}
+	}
+	
+	va_end(args);
+	
+	if (__console_printfLength) {
+		console_write(__console_printfChunk, __console_printfLength);
+	}
+}
@@ -36,29 +36,149 @@
  * Serial console driver: STC90 implementation.
  */
 
+#ifndef CONSOLE_BAUD_RATE
+#error "The CONSOLE_BAUD_RATE macro *MUST* be defined (e.g. 9600UL)"
+#endif
+
+// Maximum baud rate error, in per mille.
+#ifndef CONSOLE_BAUD_RATE_TOLERANCE
+#define CONSOLE_BAUD_RATE_TOLERANCE 20
+#endif
+
+/*
+ * The baud rate generator is set up at compile time: its divider is 
+ * the number of oscillator cycles per bit divided by the prescaler, 
+ * rounded to nearest. In 6T mode, prescalers are halved.
+ * 
+ * As a baud rate generator, Timer 2 counts oscillator cycles divided 
+ * by 2, and UART shifts one bit every 16 overflows. Timer 1 (mode 2, 
+ * 8-bit auto-reload) counts oscillator cycles divided by 12, and UART 
+ * shifts one bit every 16 (SMOD set) or 32 overflows.
+ */
 #if T_CPU == 6
-#define PRESCALING 16UL
+#define __CONSOLE_T2_PRESCALER 16UL
+#define __CONSOLE_T1_PRESCALER 96UL
+#else
+#define __CONSOLE_T2_PRESCALER 32UL
+#define __CONSOLE_T1_PRESCALER 192UL
+#endif
+
+#define __CONSOLE_DIVIDER(prescaler) ((F_CPU + (prescaler) * CONSOLE_BAUD_RATE / 2) / ((prescaler) * CONSOLE_BAUD_RATE))
+
+// Oscillator cycles per bit at the baud rate we actually get, 
+// multiplied by CONSOLE_BAUD_RATE.
+#define __CONSOLE_ACTUAL_F_CPU(prescaler) ((prescaler) * __CONSOLE_DIVIDER(prescaler) * CONSOLE_BAUD_RATE)
+
+// Difference between the above and F_CPU.
+#define __CONSOLE_ERROR(prescaler) (F_CPU > __CONSOLE_ACTUAL_F_CPU(prescaler) ? F_CPU - __CONSOLE_ACTUAL_F_CPU(prescaler) : __CONSOLE_ACTUAL_F_CPU(prescaler) - F_CPU)
+
+// With Timer 1, we use SMOD unless the divider doesn't fit.
+#if __CONSOLE_DIVIDER(__CONSOLE_T1_PRESCALER) <= 256UL
+#define __CONSOLE_T1_SMOD 1
+#define __CONSOLE_T1_ACTUAL_PRESCALER __CONSOLE_T1_PRESCALER
 #else
-#define PRESCALING 32UL
+#define __CONSOLE_T1_SMOD 0
+#define __CONSOLE_T1_ACTUAL_PRESCALER (__CONSOLE_T1_PRESCALER * 2UL)
+#endif
+
+/*
+ * Unless CONSOLE_BAUD_RATE_TIMER is defined as 1 or 2, we use the 
+ * timer giving the smaller error, Timer 1 in case of a tie.
+ */
+#ifndef CONSOLE_BAUD_RATE_TIMER
+#if __CONSOLE_DIVIDER(__CONSOLE_T1_ACTUAL_PRESCALER) == 0 || __CONSOLE_DIVIDER(__CONSOLE_T1_ACTUAL_PRESCALER) > 256UL
+#define CONSOLE_BAUD_RATE_TIMER 2
+#elif __CONSOLE_DIVIDER(__CONSOLE_T2_PRESCALER) == 0 || __CONSOLE_DIVIDER(__CONSOLE_T2_PRESCALER) > 65536UL
+#define CONSOLE_BAUD_RATE_TIMER 1
+#elif __CONSOLE_ERROR(__CONSOLE_T1_ACTUAL_PRESCALER) <= __CONSOLE_ERROR(__CONSOLE_T2_PRESCALER)
+#define CONSOLE_BAUD_RATE_TIMER 1
+#else
+#define CONSOLE_BAUD_RATE_TIMER 2
+#endif
+#endif // CONSOLE_BAUD_RATE_TIMER
+
+#if CONSOLE_BAUD_RATE_TIMER == 1
+#define __CONSOLE_PRESCALER __CONSOLE_T1_ACTUAL_PRESCALER
+#define __CONSOLE_DIVIDER_MAX 256UL
+#elif CONSOLE_BAUD_RATE_TIMER == 2
+#define __CONSOLE_PRESCALER __CONSOLE_T2_PRESCALER
+#define __CONSOLE_DIVIDER_MAX 65536UL
+#else
+#error "CONSOLE_BAUD_RATE_TIMER must be 1 or 2"
+#endif // CONSOLE_BAUD_RATE_TIMER
+
+#if __CONSOLE_DIVIDER(__CONSOLE_PRESCALER) > __CONSOLE_DIVIDER_MAX
+#error "CONSOLE_BAUD_RATE is too low for F_CPU"
 #endif
 
+#if __CONSOLE_DIVIDER(__CONSOLE_PRESCALER) == 0
+#error "CONSOLE_BAUD_RATE is too high for F_CPU"
+#endif
+
+#if __CONSOLE_ERROR(__CONSOLE_PRESCALER) * 1000UL > CONSOLE_BAUD_RATE_TOLERANCE * __CONSOLE_ACTUAL_F_CPU(__CONSOLE_PRESCALER)
+#error "CONSOLE_BAUD_RATE can't be achieved at F_CPU within CONSOLE_BAUD_RATE_TOLERANCE"
+#endif
+
+#define __CONSOLE_RELOAD_VALUE (__CONSOLE_DIVIDER_MAX - __CONSOLE_DIVIDER(__CONSOLE_PRESCALER))
+
 volatile char __console_sending;
 
-#define INPUT_BUFFER_SIZE 16
-unsigned char __console_inputBuffer[INPUT_BUFFER_SIZE];
+#ifndef CONSOLE_OUTPUT_BUFFER_SIZE
+#define CONSOLE_OUTPUT_BUFFER_SIZE 16
+#endif
+
+#ifndef CONSOLE_INPUT_BUFFER_SIZE
+#define CONSOLE_INPUT_BUFFER_SIZE 16
+#endif
+
+#ifndef CONSOLE_BUFFER_SPACE
+#define CONSOLE_BUFFER_SPACE
+#endif
+
+#if CONSOLE_OUTPUT_BUFFER_SIZE < 2 || CONSOLE_OUTPUT_BUFFER_SIZE > 256 || (CONSOLE_OUTPUT_BUFFER_SIZE & (CONSOLE_OUTPUT_BUFFER_SIZE - 1))
+#error "CONSOLE_OUTPUT_BUFFER_SIZE must be a power of 2 between 2 and 256"
+#endif
+
+#if CONSOLE_INPUT_BUFFER_SIZE < 2 || CONSOLE_INPUT_BUFFER_SIZE > 256 || (CONSOLE_INPUT_BUFFER_SIZE & (CONSOLE_INPUT_BUFFER_SIZE - 1))
+#error "CONSOLE_INPUT_BUFFER_SIZE must be a power of 2 between 2 and 256"
+#endif
+
+// Buffer sizes are powers of 2, so indexes wrap by simple masking.
+#define OUTPUT_BUFFER_MASK ((unsigned char) (CONSOLE_OUTPUT_BUFFER_SIZE - 1))
+#define INPUT_BUFFER_MASK ((unsigned char) (CONSOLE_INPUT_BUFFER_SIZE - 1))
+
+CONSOLE_BUFFER_SPACE unsigned char __console_outputBuffer[CONSOLE_OUTPUT_BUFFER_SIZE];
+volatile unsigned char __console_outputFirst;
+volatile unsigned char __console_outputNext;
+
+CONSOLE_BUFFER_SPACE unsigned char __console_inputBuffer[CONSOLE_INPUT_BUFFER_SIZE];
 volatile unsigned char __console_bufferFirst;
 volatile unsigned char __console_bufferNext;
 
 // TxD is on P3.1 (pin 11 on DIP40) and RxD on P3.0 (pin 10 on DIP40)
-void console_initialise(unsigned long baudRate) {
+void console_initialise() {
+#if CONSOLE_BAUD_RATE_TIMER == 1
+	// Timer 1 in mode 2 (8-bit auto-reload), as a timer
+	TR1 = 0;
+	TMOD = (TMOD & 0x0F) | T1_M1;
+	TL1 = TH1 = (unsigned char) __CONSOLE_RELOAD_VALUE;
+	
+#if __CONSOLE_T1_SMOD
+	PCON |= SMOD;
+#else
+	PCON &= ~SMOD;
+#endif // __CONSOLE_T1_SMOD
+	
+	// Start Timer 1 (used by UART unless RCLK and TCLK are set).
+	TR1 = 1;
+#else
 	// Set Timer 2 reload value
-	// If PCON |= SMOD; then PRESCALING must be divided by 2.
-	unsigned int reloadValue =  (unsigned int) (65536UL - (F_CPU / baudRate / PRESCALING));
-	T2L = RCAP2L = reloadValue & 0xFF;
-	T2H = RCAP2H = reloadValue >> 8;
+	TL2 = RCAP2L = (unsigned char) (__CONSOLE_RELOAD_VALUE & 0xFF);
+	TH2 = RCAP2H = (unsigned char) (__CONSOLE_RELOAD_VALUE >> 8);
 	
 	// Define Timer 2 as baud rate generator for UART, and start it.
 	T2CON = 0x34;
+#endif // CONSOLE_BAUD_RATE_TIMER
 	
 	// Set UART in mode 1 and clear interrupt flags
 	SCON = 0x50;
@@ -68,29 +188,34 @@ void console_initialise(unsigned long baudRate) {
 	
 	__console_bufferFirst = 0;
 	__console_bufferNext = 0;
+	__console_outputFirst = 0;
+	__console_outputNext = 0;
 	__console_sending = 0;
 }
 
 void __uart1_isr() __interrupt UART1_INTERRUPT __using 1 __critical {
 	if (TI) {
 		TI = 0;
-		__console_sending = 0;
+		
+		if (__console_outputFirst != __console_outputNext) {
+			// Send the next character waiting in the output buffer.
+			SBUF = __console_outputBuffer[__console_outputFirst];
+			__console_outputFirst = (__console_outputFirst + 1) & OUTPUT_BUFFER_MASK;
+		} else {
+			__console_sending = 0;
+		}
 	}
 
 	if (RI) {
 		RI = 0;
 		
-		int ptrDiff = __console_bufferNext - __console_bufferFirst;
-		// ptrDiff == 0 => Buffer is empty.
+		unsigned char next = (__console_bufferNext + 1) & INPUT_BUFFER_MASK;
+		
 		// Buffer is considered full if, when incremented, bufferNext 
 		// would become equal to bufferFirst.
-		
-		if (ptrDiff != -1 && ptrDiff != (INPUT_BUFFER_SIZE - 1)) {
-			__console_inputBuffer[__console_bufferNext++] = SBUF;
-			
-			if (__console_bufferNext == INPUT_BUFFER_SIZE) {
-				__console_bufferNext = 0;
-			}
+		if (next != __console_bufferFirst) {
+			__console_inputBuffer[__console_bufferNext] = SBUF;
+			__console_bufferNext = next;
 		}
 	}
 }
@@ -99,21 +224,103 @@ unsigned char console_readCharacter() {
 	unsigned char result = 0;
 	
 	if (__console_bufferFirst != __console_bufferNext) {
-		result = __console_inputBuffer[__console_bufferFirst++];
-		
-		if (__console_bufferFirst == INPUT_BUFFER_SIZE) {
-			__console_bufferFirst = 0;
-		}
+		result = __console_inputBuffer[__console_bufferFirst];
+		__console_bufferFirst = (__console_bufferFirst + 1) & INPUT_BUFFER_MASK;
 	}
 	
 	return result;
 }
 
+uint8_t console_available() {
+	return (__console_bufferNext - __console_bufferFirst) & INPUT_BUFFER_MASK;
+}
+
+uint8_t console_tryReadCharacter(uint8_t *c) {
+	if (__console_bufferFirst == __console_bufferNext) {
+		return 0;
+	}
+	
+	*c = __console_inputBuffer[__console_bufferFirst];
+	__console_bufferFirst = (__console_bufferFirst + 1) & INPUT_BUFFER_MASK;
+	
+	return 1;
+}
+
+uint8_t console_read(uint8_t *buffer, uint8_t maxLength) {
+	uint8_t count = 0;
+	uint8_t first = __console_bufferFirst;
+	// Snapshot of the index updated by the ISR.
+	uint8_t next = __console_bufferNext;
+	
+	while (first != next && count < maxLength) {
+		buffer[count++] = __console_inputBuffer[first];
+		first = (first + 1) & INPUT_BUFFER_MASK;
+	}
+	
+	__console_bufferFirst = first;
+	
+	return count;
+}
+
+void __console_startSending(unsigned char next) {
+	__critical {
+		__console_outputNext = next;
+		
+		if (!__console_sending) {
+			// The UART is idle: (re-)start transmission, the ISR 
+			// will take care of the rest of the buffer.
+			__console_sending = 1;
+			SBUF = __console_outputBuffer[__console_outputFirst];
+			__console_outputFirst = (__console_outputFirst + 1) & OUTPUT_BUFFER_MASK;
+		}
+	}
+}
+
 void console_sendCharacter(unsigned char c) {
-	while (__console_sending) {
+	unsigned char next = (__console_outputNext + 1) & OUTPUT_BUFFER_MASK;
+	
+	// Only wait if the output buffer is full.
+	while (next == __console_outputFirst) {
 		__asm nop __endasm;
 	}
 	
-	__console_sending = 1;
-    SBUF = c;
+	__console_outputBuffer[__console_outputNext] = c;
+	__console_startSending(next);
+}
+
+void console_write(const uint8_t *buffer, uint8_t length) {
+	uint8_t next = __console_outputNext;
+	
+	while (length) {
+		// Take a single snapshot of the index updated by the ISR: 
+		// it can only move forward, so the free space we compute 
+		// here can only be underestimated.
+		uint8_t first = __console_outputFirst;
+		uint8_t count = (first - next - 1) & OUTPUT_BUFFER_MASK;
+		
+		if (count == 0) {
+			// Output buffer is full.
+			__asm nop __endasm;
+			continue;
+		}
+		
+		if (count > length) {
+			count = length;
+		}
+		
+		length -= count;
+		
+		for (; count; count--) {
+			__console_outputBuffer[next] = *buffer++;
+			next = (next + 1) & OUTPUT_BUFFER_MASK;
+		}
+		
+		__console_startSending(next);
+	}
+}
+
+void console_flush() {
+	while (__console_sending) {
+		__asm nop __endasm;
+	}
 }
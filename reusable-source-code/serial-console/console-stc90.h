@@ -30,6 +30,8 @@
 #ifndef _CONSOLE_STC90_H
 #define _CONSOLE_STC90_H
 
+#include <stdint.h>
+
 /**
  * @file console-stc90.h
  * 
@@ -50,24 +52,68 @@
  * 
  * Configures the UART and initialises the driver's internal state.
  * 
+ * The baud rate is given by the CONSOLE_BAUD_RATE macro, and the 
+ * baud rate generator settings are worked out at compile time.
+ * 
  * Note the console uses the one and only UART of the poor STC90...
  */
-void console_initialise(unsigned long baudRate);
+void console_initialise();
 
 /**
  * Initiates the transmission of a character.
  * 
  * The character is placed in the output buffer, and transmission is 
- * (re-)started if needed.
+ * (re-)started if needed. The output buffer is drained by the UART 
+ * ISR, so this function returns immediately unless the buffer is full.
  */
 void console_sendCharacter(unsigned char c);
 
+/**
+ * Waits until the output buffer is empty and the last character 
+ * has been sent.
+ */
+void console_flush();
+
 /**
  * @returns the next character available in the input buffer, 
  * or 0 if the buffer was empty.
+ * 
+ * As a received 0 can't be told apart from an empty buffer, use 
+ * console_tryReadCharacter() for binary data.
  */
 unsigned char console_readCharacter();
 
+/**
+ * @returns the number of characters available in the input buffer.
+ */
+uint8_t console_available();
+
+/**
+ * Removes the next character from the input buffer, if any, and 
+ * stores it in c. Doesn't wait for characters to be received.
+ * 
+ * @returns 1 if a character was read, 0 if the buffer was empty.
+ */
+uint8_t console_tryReadCharacter(uint8_t *c);
+
+/**
+ * Places a block of characters in the output buffer, waiting for 
+ * room to become available if needed.
+ * 
+ * Unlike calling console_sendCharacter() in a loop, the output buffer 
+ * state is only read and updated once per contiguous block of free 
+ * space, which is significantly faster.
+ */
+void console_write(const uint8_t *buffer, uint8_t length);
+
+/**
+ * Copies at most maxLength characters from the input buffer into 
+ * the given buffer. Doesn't wait for characters to be received.
+ * 
+ * @returns the number of characters actually copied.
+ */
+uint8_t console_read(uint8_t *buffer, uint8_t maxLength);
+
 void __uart1_isr() __interrupt UART1_INTERRUPT __using 1;
 
 #endif // _CONSOLE_STC90_H
@@ -34,6 +34,7 @@
  * Maps standard I/O functions (e.g. printf) to the serial console.
  */
 
+#include "project-defs.h"
 #include "console.h"
 #include <stdio.h>
 
@@ -44,11 +45,13 @@ int putchar(int c) {
 
 int getchar() {
 	// Blocking character input.
-	while (1) {
-		unsigned char result = console_readCharacter();
-		
-		if (result) {
-			return result;
-		}
-	}
+	uint8_t result;
+	
+#ifdef CONSOLE_IDLE_WAIT
+	console_waitCharacter(&result, 0);
+#else
+	while (!console_tryReadCharacter(&result));
+#endif // CONSOLE_IDLE_WAIT
+	
+	return result;
 }
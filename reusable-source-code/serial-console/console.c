@@ -27,6 +27,7 @@
  * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <string.h>
 #include "project-defs.h"
 #include "console.h"
 
@@ -41,22 +42,612 @@
 #define __MCU_IS_STC8
 #endif // _STC8AF_H || _STC8G_H || _STC8H_H
 
+#ifdef CONSOLE_USE_DMA
+#ifndef _STC8H_H
+#error "CONSOLE_USE_DMA is only supported on STC8H"
+#endif // _STC8H_H
+
+// The DMA controller can only access XRAM.
+#undef CONSOLE_BUFFER_SPACE
+#define CONSOLE_BUFFER_SPACE __xdata
+#endif // CONSOLE_USE_DMA
+
+#if defined(CONSOLE_FLOW_CONTROL_RTS_CTS) || defined(CONSOLE_FLOW_CONTROL_XON_XOFF)
+#define __CONSOLE_FLOW_CONTROL
+
+#ifdef CONSOLE_USE_DMA
+#error "Flow control is not supported in DMA mode"
+#endif // CONSOLE_USE_DMA
+#endif // CONSOLE_FLOW_CONTROL_RTS_CTS || CONSOLE_FLOW_CONTROL_XON_XOFF
+
+#ifdef CONSOLE_RS485_DE_PORT
+#include "gpio.h"
+
+#ifdef CONSOLE_USE_DMA
+#error "CONSOLE_RS485_DE_PORT is not supported in DMA mode"
+#endif // CONSOLE_USE_DMA
+
+// RS-485 transceiver driver enable pin, active high.
+GpioConfig __console_rs485DriverEnable = GPIO_PIN_CONFIG(CONSOLE_RS485_DE_PORT, CONSOLE_RS485_DE_PIN, GPIO_PUSH_PULL);
+
+#define __CONSOLE_DE_MASK ((unsigned char) (1 << CONSOLE_RS485_DE_PIN))
+
+/*
+ * Sets or clears the driver enable pin. Port and pin are constants, 
+ * so this is reduced to a single port update at compile time.
+ */
+inline void __console_driverEnable(char enable) {
+	switch (CONSOLE_RS485_DE_PORT) {
+	case GPIO_PORT0:
+		P0 = enable ? P0 | __CONSOLE_DE_MASK : P0 & ~__CONSOLE_DE_MASK;
+		break;
+	
+	case GPIO_PORT1:
+		P1 = enable ? P1 | __CONSOLE_DE_MASK : P1 & ~__CONSOLE_DE_MASK;
+		break;
+	
+	case GPIO_PORT2:
+		P2 = enable ? P2 | __CONSOLE_DE_MASK : P2 & ~__CONSOLE_DE_MASK;
+		break;
+	
+	case GPIO_PORT3:
+		P3 = enable ? P3 | __CONSOLE_DE_MASK : P3 & ~__CONSOLE_DE_MASK;
+		break;
+	
+	case GPIO_PORT4:
+		P4 = enable ? P4 | __CONSOLE_DE_MASK : P4 & ~__CONSOLE_DE_MASK;
+		break;
+	
+	case GPIO_PORT5:
+		P5 = enable ? P5 | __CONSOLE_DE_MASK : P5 & ~__CONSOLE_DE_MASK;
+		break;
+
+#ifdef __GPIO_HAS_PORTS67
+	case GPIO_PORT6:
+		P6 = enable ? P6 | __CONSOLE_DE_MASK : P6 & ~__CONSOLE_DE_MASK;
+		break;
+	
+	case GPIO_PORT7:
+		P7 = enable ? P7 | __CONSOLE_DE_MASK : P7 & ~__CONSOLE_DE_MASK;
+		break;
+#endif // __GPIO_HAS_PORTS67
+	}
+}
+#else
+#define __console_driverEnable(enable)
+#endif // CONSOLE_RS485_DE_PORT
+
+#ifdef CONSOLE_MULTIPROCESSOR_ADDRESS
+#ifdef CONSOLE_USE_DMA
+#error "CONSOLE_MULTIPROCESSOR_ADDRESS is not supported in DMA mode"
+#endif // CONSOLE_USE_DMA
+
+#ifndef CONSOLE_BROADCAST_ADDRESS
+#define CONSOLE_BROADCAST_ADDRESS 0xFF
+#endif
+
+// Start bit, 8 data bits, address/data bit, stop bit.
+#define __CONSOLE_CHARACTER_BITS 11UL
+#else
+// Start bit, 8 data bits, stop bit.
+#define __CONSOLE_CHARACTER_BITS 10UL
+#endif // CONSOLE_MULTIPROCESSOR_ADDRESS
+
+#ifndef CONSOLE_BAUD_RATE
+#error "The CONSOLE_BAUD_RATE macro *MUST* be defined (e.g. 9600UL)"
+#endif
+
+// Maximum baud rate error, in per mille.
+#ifndef CONSOLE_BAUD_RATE_TOLERANCE
+#define CONSOLE_BAUD_RATE_TOLERANCE 20
+#endif
+
+/*
+ * The baud rate generator is set up at compile time: its divider is 
+ * the number of SYSclk cycles per bit divided by the prescaler of the 
+ * clock source, rounded to nearest. We use the clock source with the 
+ * smallest prescaler (i.e. the finest resolution) for which the 
+ * divider fits in the timer.
+ */
+#define __CONSOLE_DIVIDER(prescaler) ((F_CPU + (prescaler) * CONSOLE_BAUD_RATE / 2) / ((prescaler) * CONSOLE_BAUD_RATE))
+
+#if defined(__MCU_IS_STC8) || defined(_STC15_H)
+// UART2 shifts one bit every 4 overflows of 16-bit Timer 2, 
+// clocked at SYSclk/1 (T2x12) or SYSclk/12.
+#define __CONSOLE_DIVIDER_MAX 65536UL
+
+#if __CONSOLE_DIVIDER(4UL) <= __CONSOLE_DIVIDER_MAX
+#define __CONSOLE_PRESCALER 4UL
+#define __CONSOLE_AUXR T2x12
+#else
+#define __CONSOLE_PRESCALER 48UL
+#define __CONSOLE_AUXR 0
+#endif
+#endif // __MCU_IS_STC8 || _STC15_H
+
+#if defined(_STC12_H)
+// UART2 shifts one bit every 16 (S2SMOD) or 32 overflows of the 
+// 8-bit baud rate timer, clocked at SYSclk/1 (BRTx12) or SYSclk/12.
+#define __CONSOLE_DIVIDER_MAX 256UL
+
+#if __CONSOLE_DIVIDER(16UL) <= __CONSOLE_DIVIDER_MAX
+#define __CONSOLE_PRESCALER 16UL
+#define __CONSOLE_AUXR (BRTx12 | S2SMOD)
+#elif __CONSOLE_DIVIDER(32UL) <= __CONSOLE_DIVIDER_MAX
+#define __CONSOLE_PRESCALER 32UL
+#define __CONSOLE_AUXR BRTx12
+#elif __CONSOLE_DIVIDER(192UL) <= __CONSOLE_DIVIDER_MAX
+#define __CONSOLE_PRESCALER 192UL
+#define __CONSOLE_AUXR S2SMOD
+#else
+#define __CONSOLE_PRESCALER 384UL
+#define __CONSOLE_AUXR 0
+#endif
+#endif // _STC12_H
+
+#define __CONSOLE_DIVIDER_VALUE __CONSOLE_DIVIDER(__CONSOLE_PRESCALER)
+
+#if __CONSOLE_DIVIDER_VALUE > __CONSOLE_DIVIDER_MAX
+#error "CONSOLE_BAUD_RATE is too low for F_CPU"
+#endif
+
+#if __CONSOLE_DIVIDER_VALUE == 0
+#error "CONSOLE_BAUD_RATE is too high for F_CPU"
+#endif
+
+// SYSclk cycles per bit at the baud rate we actually get, 
+// multiplied by CONSOLE_BAUD_RATE.
+#define __CONSOLE_ACTUAL_F_CPU (__CONSOLE_PRESCALER * __CONSOLE_DIVIDER_VALUE * CONSOLE_BAUD_RATE)
+
+#if (F_CPU > __CONSOLE_ACTUAL_F_CPU ? F_CPU - __CONSOLE_ACTUAL_F_CPU : __CONSOLE_ACTUAL_F_CPU - F_CPU) * 1000UL > CONSOLE_BAUD_RATE_TOLERANCE * __CONSOLE_ACTUAL_F_CPU
+#error "CONSOLE_BAUD_RATE can't be achieved at F_CPU within CONSOLE_BAUD_RATE_TOLERANCE"
+#endif
+
+#define __CONSOLE_RELOAD_VALUE (__CONSOLE_DIVIDER_MAX - __CONSOLE_DIVIDER_VALUE)
+
+#ifdef CONSOLE_RS485_DE_PORT
+/*
+ * S2TI is set at the start of the stop bit, so the driver must stay 
+ * enabled one more bit time after the last one, or the transceiver 
+ * would stop driving the line in the middle of that stop bit. It's 
+ * spent in the same empty loop as the bit-banged drivers (see 
+ * ../bit-banging), nested to fit in 8-bit counters, and rounded up.
+ */
+#ifdef __MCU_IS_STC8
+#define __CONSOLE_LOOP_CYCLES 6UL
+#else
+#define __CONSOLE_LOOP_CYCLES 10UL
+#endif // __MCU_IS_STC8
+
+#define __CONSOLE_BIT_LOOPS ((__CONSOLE_PRESCALER * __CONSOLE_DIVIDER_VALUE + __CONSOLE_LOOP_CYCLES - 1UL) / __CONSOLE_LOOP_CYCLES)
+#define __CONSOLE_BIT_OUTER_LOOPS ((__CONSOLE_BIT_LOOPS + 254UL) / 255UL)
+#define __CONSOLE_BIT_INNER_LOOPS ((__CONSOLE_BIT_LOOPS + __CONSOLE_BIT_OUTER_LOOPS - 1UL) / __CONSOLE_BIT_OUTER_LOOPS)
+
+#if __CONSOLE_BIT_OUTER_LOOPS > 255UL
+#error "CONSOLE_BAUD_RATE is too low for CONSOLE_RS485_DE_PORT"
+#endif
+
+/*
+ * Waits for the end of the stop bit of the last character, then 
+ * releases the bus.
+ */
+inline void __console_driverRelease() {
+	for (unsigned char outer = __CONSOLE_BIT_OUTER_LOOPS; outer; outer--) {
+		for (unsigned char inner = __CONSOLE_BIT_INNER_LOOPS; inner; inner--) {}
+	}
+	
+	__console_driverEnable(0);
+}
+#else
+#define __console_driverRelease()
+#endif // CONSOLE_RS485_DE_PORT
+
 volatile char __console_sending;
 
-#define INPUT_BUFFER_SIZE 16
-unsigned char __console_inputBuffer[INPUT_BUFFER_SIZE];
+#ifndef CONSOLE_OUTPUT_BUFFER_SIZE
+#define CONSOLE_OUTPUT_BUFFER_SIZE 16
+#endif
+
+#ifndef CONSOLE_INPUT_BUFFER_SIZE
+#define CONSOLE_INPUT_BUFFER_SIZE 16
+#endif
+
+#ifndef CONSOLE_BUFFER_SPACE
+#define CONSOLE_BUFFER_SPACE
+#endif
+
+#if CONSOLE_OUTPUT_BUFFER_SIZE < 2 || CONSOLE_OUTPUT_BUFFER_SIZE > 256 || (CONSOLE_OUTPUT_BUFFER_SIZE & (CONSOLE_OUTPUT_BUFFER_SIZE - 1))
+#error "CONSOLE_OUTPUT_BUFFER_SIZE must be a power of 2 between 2 and 256"
+#endif
+
+#if CONSOLE_INPUT_BUFFER_SIZE < 2 || CONSOLE_INPUT_BUFFER_SIZE > 256 || (CONSOLE_INPUT_BUFFER_SIZE & (CONSOLE_INPUT_BUFFER_SIZE - 1))
+#error "CONSOLE_INPUT_BUFFER_SIZE must be a power of 2 between 2 and 256"
+#endif
+
+#ifdef __CONSOLE_FLOW_CONTROL
+#ifndef CONSOLE_INPUT_HIGH_WATER
+#define CONSOLE_INPUT_HIGH_WATER (CONSOLE_INPUT_BUFFER_SIZE * 3 / 4)
+#endif
+
+#ifndef CONSOLE_INPUT_LOW_WATER
+#define CONSOLE_INPUT_LOW_WATER (CONSOLE_INPUT_BUFFER_SIZE / 4)
+#endif
+
+#if CONSOLE_INPUT_HIGH_WATER >= CONSOLE_INPUT_BUFFER_SIZE || CONSOLE_INPUT_LOW_WATER >= CONSOLE_INPUT_HIGH_WATER
+#error "Flow control requires CONSOLE_INPUT_LOW_WATER < CONSOLE_INPUT_HIGH_WATER < CONSOLE_INPUT_BUFFER_SIZE"
+#endif
+
+// Set when we asked the remote end to stop sending.
+volatile char __console_inputStopped;
+#endif // __CONSOLE_FLOW_CONTROL
+
+#ifdef CONSOLE_FRAME_TIMEOUT
+#ifdef CONSOLE_USE_DMA
+#error "CONSOLE_FRAME_TIMEOUT is not supported in DMA mode"
+#endif // CONSOLE_USE_DMA
+
+#ifndef CONSOLE_FRAME_QUEUE_SIZE
+#define CONSOLE_FRAME_QUEUE_SIZE 4
+#endif
+
+#if CONSOLE_FRAME_QUEUE_SIZE < 2 || CONSOLE_FRAME_QUEUE_SIZE > 256 || (CONSOLE_FRAME_QUEUE_SIZE & (CONSOLE_FRAME_QUEUE_SIZE - 1))
+#error "CONSOLE_FRAME_QUEUE_SIZE must be a power of 2 between 2 and 256"
+#endif
+
+#define FRAME_QUEUE_MASK ((unsigned char) (CONSOLE_FRAME_QUEUE_SIZE - 1))
+
+/*
+ * Timer 0 is restarted by each received character, and overflows 
+ * after CONSOLE_FRAME_TIMEOUT tenths of a character time of silence. 
+ * It's clocked at SYSclk/1 if that fits in 16 bits, at SYSclk/12 
+ * otherwise.
+ */
+#define __CONSOLE_FRAME_CYCLES ((F_CPU / 10UL * CONSOLE_FRAME_TIMEOUT * __CONSOLE_CHARACTER_BITS + CONSOLE_BAUD_RATE / 2) / CONSOLE_BAUD_RATE)
+
+#if __CONSOLE_FRAME_CYCLES <= 65536UL
+#define __CONSOLE_FRAME_COUNTS __CONSOLE_FRAME_CYCLES
+#define __CONSOLE_FRAME_AUXR T0x12
+#elif __CONSOLE_FRAME_CYCLES <= 65536UL * 12UL
+#define __CONSOLE_FRAME_COUNTS ((__CONSOLE_FRAME_CYCLES + 6UL) / 12UL)
+#define __CONSOLE_FRAME_AUXR 0
+#else
+#error "CONSOLE_FRAME_TIMEOUT is too long for F_CPU and CONSOLE_BAUD_RATE"
+#endif
+
+#define __CONSOLE_FRAME_RELOAD (65536UL - __CONSOLE_FRAME_COUNTS)
+
+// Lengths of the complete frames waiting in the input buffer.
+unsigned char __console_frameLengths[CONSOLE_FRAME_QUEUE_SIZE];
+volatile unsigned char __console_frameFirst;
+volatile unsigned char __console_frameNext;
+
+// Number of characters of the frame being received.
+unsigned char __console_frameLength;
+// Set when a character of the frame being received was dropped.
+char __console_frameOverrun;
+#endif // CONSOLE_FRAME_TIMEOUT
+
+#ifdef CONSOLE_IDLE_WAIT
+#ifdef CONSOLE_FRAME_TIMEOUT
+#error "CONSOLE_IDLE_WAIT and CONSOLE_FRAME_TIMEOUT both need Timer 0"
+#endif // CONSOLE_FRAME_TIMEOUT
+
+// Timer 0, clocked at SYSclk/12, overflows every millisecond 
+// while we're waiting for input.
+#define __CONSOLE_WAIT_COUNTS ((F_CPU + 6000UL) / 12000UL)
+
+#if __CONSOLE_WAIT_COUNTS > 65536UL
+#error "F_CPU is too high for CONSOLE_IDLE_WAIT"
+#endif
+
+#define __CONSOLE_WAIT_RELOAD (65536UL - __CONSOLE_WAIT_COUNTS)
+
+// Number of Timer 0 overflows, modulo 256.
+volatile unsigned char __console_waitTicks;
+#endif // CONSOLE_IDLE_WAIT
+
+#ifdef CONSOLE_STATISTICS
+ConsoleStatistics __console_statistics;
+#endif // CONSOLE_STATISTICS
+
+#ifdef CONSOLE_FLOW_CONTROL_XON_XOFF
+#define XON 0x11
+#define XOFF 0x13
+
+// XON or XOFF character to send ahead of the output buffer, or 0.
+volatile unsigned char __console_controlCharacter;
+// Set when the remote end asked us to stop sending.
+volatile char __console_outputStopped;
+
+#define __console_clearToSend() (!__console_outputStopped)
+#elif defined(CONSOLE_FLOW_CONTROL_RTS_CTS)
+// RTS and CTS are active low.
+#define __console_clearToSend() (!CONSOLE_CTS)
+#else
+#define __console_clearToSend() 1
+#endif // CONSOLE_FLOW_CONTROL_XON_XOFF
+
+// Buffer sizes are powers of 2, so indexes wrap by simple masking.
+#define OUTPUT_BUFFER_MASK ((unsigned char) (CONSOLE_OUTPUT_BUFFER_SIZE - 1))
+#define INPUT_BUFFER_MASK ((unsigned char) (CONSOLE_INPUT_BUFFER_SIZE - 1))
+
+CONSOLE_BUFFER_SPACE unsigned char __console_outputBuffer[CONSOLE_OUTPUT_BUFFER_SIZE];
+volatile unsigned char __console_outputFirst;
+volatile unsigned char __console_outputNext;
+
+CONSOLE_BUFFER_SPACE unsigned char __console_inputBuffer[CONSOLE_INPUT_BUFFER_SIZE];
 volatile unsigned char __console_bufferFirst;
 volatile unsigned char __console_bufferNext;
 
-void console_initialise(unsigned long baudRate) {
+#ifdef CONSOLE_USE_DMA
+// Length of the block being transferred, or 0 when the channel is idle.
+volatile unsigned char __console_dmaOutputLength;
+volatile unsigned char __console_dmaInputLength;
+
+/*
+ * Starts sending the next contiguous block of the output buffer.
+ * 
+ * Must be called with interrupts disabled and extended SFR enabled.
+ */
+inline void __console_dmaSend() {
+	unsigned char first = __console_outputFirst;
+	unsigned char length = (__console_outputNext - first) & OUTPUT_BUFFER_MASK;
+	
+	if (length > CONSOLE_OUTPUT_BUFFER_SIZE - first) {
+		length = CONSOLE_OUTPUT_BUFFER_SIZE - first;
+	}
+	
+	__console_dmaOutputLength = length;
+	__console_sending = length ? 1 : 0;
+	
+	if (length) {
+		DMA_UR2T_TXAH = ((unsigned int) &__console_outputBuffer[first]) >> 8;
+		DMA_UR2T_TXAL = ((unsigned int) &__console_outputBuffer[first]) & 0xff;
+		DMA_UR2T_AMT = length - 1;
+		DMA_UR2T_CR = ENUR2T | UR2T_TRIG;
+	}
+}
+
+/*
+ * Starts receiving into the next contiguous block of free space 
+ * of the input buffer. If the input buffer is full, reception 
+ * stalls until some characters are read.
+ * 
+ * Must be called with interrupts disabled and extended SFR enabled.
+ */
+inline void __console_dmaReceive() {
+	unsigned char next = __console_bufferNext;
+	unsigned char length = (__console_bufferFirst - next - 1) & INPUT_BUFFER_MASK;
+	
+	if (length > CONSOLE_INPUT_BUFFER_SIZE - next) {
+		length = CONSOLE_INPUT_BUFFER_SIZE - next;
+	}
+	
+	__console_dmaInputLength = length;
+	
+	if (length) {
+		DMA_UR2R_RXAH = ((unsigned int) &__console_inputBuffer[next]) >> 8;
+		DMA_UR2R_RXAL = ((unsigned int) &__console_inputBuffer[next]) & 0xff;
+		DMA_UR2R_AMT = length - 1;
+		DMA_UR2R_CR = ENUR2R | UR2R_TRIG;
+	}
+}
+
+/*
+ * @returns the index following the last character received, 
+ * including those already stored by the DMA in the current block.
+ */
+unsigned char __console_receivedNext() {
+	unsigned char next;
+	
+	__critical {
+		next = __console_bufferNext;
+		
+		if (__console_dmaInputLength) {
+			enableExtendedSFR();
+			next += DMA_UR2R_DONE;
+			disableExtendedSFR();
+		}
+	}
+	
+	return next & INPUT_BUFFER_MASK;
+}
+
+void __console_releaseInput(unsigned char first) {
+	__critical {
+		__console_bufferFirst = first;
+		
+		if (!__console_dmaInputLength) {
+			// Reception stalled because the input buffer was full.
+			enableExtendedSFR();
+			__console_dmaReceive();
+			disableExtendedSFR();
+		}
+	}
+}
+#else
+#define __console_receivedNext() __console_bufferNext
+
+/*
+ * Sends the next character, if any and if the remote end is ready, 
+ * or marks the UART as idle.
+ * 
+ * Must be called with interrupts disabled.
+ */
+inline void __console_transmitNext() {
+#ifdef CONSOLE_FLOW_CONTROL_XON_XOFF
+	if (__console_controlCharacter) {
+		__console_sending = 1;
+		__console_driverEnable(1);
+		S2BUF = __console_controlCharacter;
+		__console_controlCharacter = 0;
+		return;
+	}
+#endif // CONSOLE_FLOW_CONTROL_XON_XOFF
+	
+	if (__console_outputFirst != __console_outputNext && __console_clearToSend()) {
+		__console_sending = 1;
+		__console_driverEnable(1);
+		S2BUF = __console_outputBuffer[__console_outputFirst];
+		__console_outputFirst = (__console_outputFirst + 1) & OUTPUT_BUFFER_MASK;
+	} else if (__console_sending) {
+		// The last character has been sent: release the bus.
+		__console_driverRelease();
+		__console_sending = 0;
+	}
+}
+
+#ifdef __CONSOLE_FLOW_CONTROL
+/*
+ * Asks the remote end to stop (stop != 0) or resume sending.
+ * 
+ * Must be called with interrupts disabled.
+ */
+inline void __console_controlInput(char stop) {
+	__console_inputStopped = stop;
+	
+#ifdef CONSOLE_FLOW_CONTROL_RTS_CTS
+	CONSOLE_RTS = stop;
+#else
+	__console_controlCharacter = stop ? XOFF : XON;
+	
+	if (!__console_sending) {
+		__console_transmitNext();
+	}
+#endif // CONSOLE_FLOW_CONTROL_RTS_CTS
+}
+
+void __console_releaseInput(unsigned char first) {
+	__console_bufferFirst = first;
+	
+	if (__console_inputStopped) {
+		__critical {
+			if (((__console_bufferNext - first) & INPUT_BUFFER_MASK) <= CONSOLE_INPUT_LOW_WATER) {
+				__console_controlInput(0);
+			}
+		}
+	}
+}
+#else
+#define __console_releaseInput(first) __console_bufferFirst = (first)
+#endif // __CONSOLE_FLOW_CONTROL
+
+/*
+ * Stores a received character in the input buffer, or drops it if 
+ * the buffer is full.
+ * 
+ * Must be called with interrupts disabled.
+ */
+inline void __console_receive(unsigned char c) {
+	unsigned char next = (__console_bufferNext + 1) & INPUT_BUFFER_MASK;
+	
+#ifdef CONSOLE_FRAME_TIMEOUT
+	// Restart the silence timer.
+	TR0 = 0;
+	TL0 = (unsigned char) (__CONSOLE_FRAME_RELOAD & 0xFF);
+	TH0 = (unsigned char) (__CONSOLE_FRAME_RELOAD >> 8);
+	TF0 = 0;
+	TR0 = 1;
+#endif // CONSOLE_FRAME_TIMEOUT
+	
+	// Buffer is considered full if, when incremented, bufferNext 
+	// would become equal to bufferFirst.
+	if (next != __console_bufferFirst) {
+		__console_inputBuffer[__console_bufferNext] = c;
+		__console_bufferNext = next;
+		
+#ifdef CONSOLE_FRAME_TIMEOUT
+		__console_frameLength++;
+#endif // CONSOLE_FRAME_TIMEOUT
+
+#ifdef CONSOLE_STATISTICS
+		unsigned char count = (next - __console_bufferFirst) & INPUT_BUFFER_MASK;
+		
+		if (count > __console_statistics.inputHighWater) {
+			__console_statistics.inputHighWater = count;
+		}
+#endif // CONSOLE_STATISTICS
+	} else {
+#ifdef CONSOLE_FRAME_TIMEOUT
+		__console_frameOverrun = 1;
+#endif // CONSOLE_FRAME_TIMEOUT
+
+#ifdef CONSOLE_STATISTICS
+		__console_statistics.inputOverruns++;
+#endif // CONSOLE_STATISTICS
+	}
+	
+#ifdef __CONSOLE_FLOW_CONTROL
+	if (!__console_inputStopped && ((__console_bufferNext - __console_bufferFirst) & INPUT_BUFFER_MASK) >= CONSOLE_INPUT_HIGH_WATER) {
+		__console_controlInput(1);
+	}
+#endif // __CONSOLE_FLOW_CONTROL
+}
+#endif // CONSOLE_USE_DMA
+
+void console_initialise() {
+	__console_bufferFirst = 0;
+	__console_bufferNext = 0;
+	__console_outputFirst = 0;
+	__console_outputNext = 0;
+	__console_sending = 0;
+	
+#ifdef CONSOLE_STATISTICS
+	memset(&__console_statistics, 0, sizeof(ConsoleStatistics));
+#endif // CONSOLE_STATISTICS
+	
+#ifdef __CONSOLE_FLOW_CONTROL
+	__console_inputStopped = 0;
+#endif // __CONSOLE_FLOW_CONTROL
+
+#ifdef CONSOLE_FLOW_CONTROL_XON_XOFF
+	__console_controlCharacter = 0;
+	__console_outputStopped = 0;
+#endif // CONSOLE_FLOW_CONTROL_XON_XOFF
+
+#ifdef CONSOLE_FLOW_CONTROL_RTS_CTS
+	// Tell the remote end we're ready to receive.
+	CONSOLE_RTS = 0;
+#endif // CONSOLE_FLOW_CONTROL_RTS_CTS
+
+#ifdef CONSOLE_RS485_DE_PORT
+	// Don't drive the bus until we have something to send.
+	__console_driverEnable(0);
+	gpio_configure(&__console_rs485DriverEnable);
+#endif // CONSOLE_RS485_DE_PORT
+
+#ifdef CONSOLE_FRAME_TIMEOUT
+	__console_frameFirst = 0;
+	__console_frameNext = 0;
+	__console_frameLength = 0;
+	__console_frameOverrun = 0;
+	
+	// Timer 0 in mode 1 (16-bit, no auto-reload), stopped until 
+	// the first character is received.
+	TR0 = 0;
+	TMOD = (TMOD & 0xF0) | T0_M0;
+	AUXR = (AUXR & ~T0x12) | __CONSOLE_FRAME_AUXR;
+	TF0 = 0;
+	ET0 = 1;
+#endif // CONSOLE_FRAME_TIMEOUT
+
+#ifdef CONSOLE_IDLE_WAIT
+	// Timer 0 in mode 1 (16-bit, no auto-reload), at SYSclk/12, 
+	// only running while console_waitCharacter() waits.
+	TR0 = 0;
+	TMOD = (TMOD & 0xF0) | T0_M0;
+	AUXR &= ~T0x12;
+	TF0 = 0;
+	ET0 = 1;
+#endif // CONSOLE_IDLE_WAIT
+	
 #if defined(__MCU_IS_STC8) || defined(_STC15_H)
 	// Set Timer 2 reload value
-	unsigned int reloadValue =  (unsigned int) (65536UL - (F_CPU / baudRate / 4UL));
-	T2L = reloadValue & 0xFF;
-	T2H = reloadValue >> 8;
+	T2L = (unsigned char) (__CONSOLE_RELOAD_VALUE & 0xFF);
+	T2H = (unsigned char) (__CONSOLE_RELOAD_VALUE >> 8);
 	
-	// Set clock source of Timer 2 to SYSclk/1
-	AUXR |= T2x12;
+	// Set clock source of Timer 2 to SYSclk/1 or SYSclk/12
+	AUXR = (AUXR & ~T2x12) | __CONSOLE_AUXR;
 	
 	// Start Timer 2
 	AUXR |= T2R;
@@ -67,79 +658,433 @@ void console_initialise(unsigned long baudRate) {
 	P_SW2 |= 1;
 #endif // _STC8AF_H
 	
+#ifdef CONSOLE_MULTIPROCESSOR_ADDRESS
+	// Set UART2 in 9-bit mode, only receiving address bytes (S2SM2), 
+	// and clear interrupt flags.
+	S2CON = S2SM0 | S2SM2 | S2REN;
+#else
 	// Set UART2 in mode 0 and clear interrupt flags
 	S2CON = 0x10;
+#endif // CONSOLE_MULTIPROCESSOR_ADDRESS
+	
+#ifdef CONSOLE_USE_DMA
+	// Characters are moved by the DMA controller, which only 
+	// interrupts us when a whole block has been transferred.
+	__console_dmaOutputLength = 0;
 	
+	enableExtendedSFR();
+	DMA_UR2T_CFG = UR2TIE;
+	DMA_UR2T_STA = 0;
+	DMA_UR2R_CFG = UR2RIE;
+	DMA_UR2R_STA = 0;
+	DMA_UR2R_CR = ENUR2R | UR2R_CLRFIFO;
+	__console_dmaReceive();
+	disableExtendedSFR();
+#else
 	// Enable Serial port 2 interrupt
 	IE2 |= ES2;
+#endif // CONSOLE_USE_DMA
 #endif // __MCU_IS_STC8 || _STC15_H
 
 #if defined(_STC12_H)
 	// Set baud rate timer reload value
-	BRT =  (unsigned char) (256UL - (F_CPU / baudRate / 32UL));
-	// If bit S2SMOD (double baud rate) was set in AUXR,
-	// baudRate would be divided by 16 instead of 32.
+	BRT = (unsigned char) __CONSOLE_RELOAD_VALUE;
 	
-	// Set clock source of baud rate timer to SYSclk/1
-	AUXR |= BRTx12;
+	// Set clock source of baud rate timer to SYSclk/1 or SYSclk/12, 
+	// and UART2 baud rate doubling.
+	AUXR = (AUXR & ~(BRTx12 | S2SMOD)) | __CONSOLE_AUXR;
 	
 	// Start baud rate timer
 	AUXR |= BRTR;
 	
+#ifdef CONSOLE_MULTIPROCESSOR_ADDRESS
+	// Set UART2 in mode 3 (9-bit), only receiving address bytes 
+	// (S2SM2), and clear interrupt flags.
+	S2CON = S2SM0 | S2SM1 | S2SM2 | S2REN;
+#else
 	// Set UART2 in mode 1 and clear interrupt flags
 	S2CON = 0x50;
+#endif // CONSOLE_MULTIPROCESSOR_ADDRESS
 	
 	// Enable Serial port 2 interrupt
 	IE2 |= ES2;
 #endif // _STC12_H
-	
-	__console_bufferFirst = 0;
-	__console_bufferNext = 0;
-	__console_sending = 0;
 }
 
+#ifdef CONSOLE_USE_DMA
+/*
+ * DMA interrupts can't be declared directly in C (see STC8H TRM 
+ * appendix R): their vectors jump to an ISR declared with an unused 
+ * interrupt number instead.
+ */
+void __console_dmaVectors() __naked {
+	__asm
+		.area CONSOLE_DMA_VECTORS (ABS, CODE)
+		.org DMA_UR2T_VECTOR_ADDR
+		ljmp ___uart2_dma_isr
+		.org DMA_UR2R_VECTOR_ADDR
+		ljmp ___uart2_dma_isr
+		.area CSEG (CODE)
+	__endasm;
+}
+
+void __uart2_dma_isr() __interrupt CONSOLE_DMA_INTERRUPT __using 1 __critical {
+	unsigned char savedPSW2 = P_SW2;
+	enableExtendedSFR();
+	
+	if (DMA_UR2T_STA & UR2TIF) {
+		DMA_UR2T_STA = 0;
+		__console_outputFirst = (__console_outputFirst + __console_dmaOutputLength) & OUTPUT_BUFFER_MASK;
+#ifdef CONSOLE_STATISTICS
+		__console_statistics.bytesOut += __console_dmaOutputLength;
+#endif // CONSOLE_STATISTICS
+		__console_dmaSend();
+	}
+	
+	if (DMA_UR2R_STA & UR2RIF) {
+#ifdef CONSOLE_STATISTICS
+		// Characters were lost while reception was stalled.
+		if (DMA_UR2R_STA & UR2R_RXLOSS) {
+			__console_statistics.inputOverruns++;
+		}
+		
+		__console_statistics.bytesIn += __console_dmaInputLength;
+#endif // CONSOLE_STATISTICS
+		DMA_UR2R_STA = 0;
+		__console_bufferNext = (__console_bufferNext + __console_dmaInputLength) & INPUT_BUFFER_MASK;
+#ifdef CONSOLE_STATISTICS
+		unsigned char count = (__console_bufferNext - __console_bufferFirst) & INPUT_BUFFER_MASK;
+		
+		if (count > __console_statistics.inputHighWater) {
+			__console_statistics.inputHighWater = count;
+		}
+#endif // CONSOLE_STATISTICS
+		__console_dmaReceive();
+	}
+	
+	P_SW2 = savedPSW2;
+}
+#else
 void __uart2_isr() __interrupt UART2_INTERRUPT __using 1 __critical {
 	if (S2CON & S2TI) {
 		S2CON &= ~S2TI;
-		__console_sending = 0;
+#ifdef CONSOLE_STATISTICS
+		__console_statistics.bytesOut++;
+#endif // CONSOLE_STATISTICS
+		__console_transmitNext();
 	}
 
 	if (S2CON & S2RI) {
+#ifdef CONSOLE_STATISTICS
+		__console_statistics.bytesIn++;
+		
+#ifndef CONSOLE_MULTIPROCESSOR_ADDRESS
+		// In 8-bit mode, S2RB8 holds the stop bit, which must be 1.
+		if (!(S2CON & S2RB8)) {
+			__console_statistics.framingErrors++;
+		}
+#endif // CONSOLE_MULTIPROCESSOR_ADDRESS
+#endif // CONSOLE_STATISTICS
 		S2CON &= ~S2RI;
-		int ptrDiff = __console_bufferNext - __console_bufferFirst;
-		// ptrDiff == 0 => Buffer is empty.
-		// Buffer is considered full if, when incremented, bufferNext 
-		// would become equal to bufferFirst.
+		unsigned char c = S2BUF;
+		
+#ifdef CONSOLE_MULTIPROCESSOR_ADDRESS
+		if ((S2CON & S2RB8) && c != CONSOLE_MULTIPROCESSOR_ADDRESS && c != CONSOLE_BROADCAST_ADDRESS) {
+			// Address byte for another node: ignore data bytes 
+			// until the next address byte.
+			S2CON |= S2SM2;
+			return;
+		}
 		
-		if (ptrDiff != -1 && ptrDiff != (INPUT_BUFFER_SIZE - 1)) {
-			__console_inputBuffer[__console_bufferNext++] = S2BUF;
+		// Our address, or a data byte following it: 
+		// receive data bytes.
+		S2CON &= ~S2SM2;
+#endif // CONSOLE_MULTIPROCESSOR_ADDRESS
+		
+#ifdef CONSOLE_FLOW_CONTROL_XON_XOFF
+		if (c == XOFF) {
+			__console_outputStopped = 1;
+		} else if (c == XON) {
+			__console_outputStopped = 0;
 			
-			if (__console_bufferNext == INPUT_BUFFER_SIZE) {
-				__console_bufferNext = 0;
+			if (!__console_sending) {
+				__console_transmitNext();
 			}
+		} else {
+			__console_receive(c);
 		}
+#else
+		__console_receive(c);
+#endif // CONSOLE_FLOW_CONTROL_XON_XOFF
 	}
 }
+#endif // CONSOLE_USE_DMA
 
-unsigned char console_readCharacter() {
-	unsigned char result = 0;
+#ifdef CONSOLE_FRAME_TIMEOUT
+void __console_timer0_isr() __interrupt TIMER0_INTERRUPT __using 1 __critical {
+	// No character received for CONSOLE_FRAME_TIMEOUT: 
+	// the frame is complete.
+	TR0 = 0;
+	
+	unsigned char next = (__console_frameNext + 1) & FRAME_QUEUE_MASK;
 	
-	if (__console_bufferFirst != __console_bufferNext) {
-		result = __console_inputBuffer[__console_bufferFirst++];
+	if (__console_frameOverrun || next == __console_frameFirst) {
+		// The frame is incomplete, or can't be queued: drop it. 
+		// Its characters are the last ones in the input buffer.
+		__console_bufferNext = (__console_bufferNext - __console_frameLength) & INPUT_BUFFER_MASK;
+	} else {
+		__console_frameLengths[__console_frameNext] = __console_frameLength;
+		__console_frameNext = next;
+	}
+	
+	__console_frameLength = 0;
+	__console_frameOverrun = 0;
+}
+
+uint8_t console_frameLength() {
+	uint8_t first = __console_frameFirst;
+	
+	return first != __console_frameNext ? __console_frameLengths[first] : 0;
+}
+
+uint8_t console_readFrame(uint8_t *buffer, uint8_t maxLength) {
+	uint8_t first = __console_frameFirst;
+	
+	if (first == __console_frameNext) {
+		return 0;
+	}
+	
+	uint8_t length = __console_frameLengths[first];
+	uint8_t in = __console_bufferFirst;
+	
+	for (uint8_t count = 0; count < length && count < maxLength; count++) {
+		buffer[count] = __console_inputBuffer[in];
+		in = (in + 1) & INPUT_BUFFER_MASK;
+	}
+	
+	// Characters beyond maxLength are discarded.
+	__console_releaseInput((__console_bufferFirst + length) & INPUT_BUFFER_MASK);
+	__console_frameFirst = (first + 1) & FRAME_QUEUE_MASK;
+	
+	return length;
+}
+#endif // CONSOLE_FRAME_TIMEOUT
+
+#ifdef CONSOLE_IDLE_WAIT
+void __console_timer0_isr() __interrupt TIMER0_INTERRUPT __using 1 __critical {
+	TL0 = (unsigned char) (__CONSOLE_WAIT_RELOAD & 0xFF);
+	TH0 = (unsigned char) (__CONSOLE_WAIT_RELOAD >> 8);
+	__console_waitTicks++;
+}
+
+uint8_t console_waitCharacter(uint8_t *c, uint16_t timeout) {
+	uint8_t result;
+	uint8_t ticks = __console_waitTicks;
+	
+	TL0 = (unsigned char) (__CONSOLE_WAIT_RELOAD & 0xFF);
+	TH0 = (unsigned char) (__CONSOLE_WAIT_RELOAD >> 8);
+	TR0 = 1;
+	
+	while (!(result = console_tryReadCharacter(c))) {
+		// Snapshot of the counter updated by the ISR.
+		uint8_t now = __console_waitTicks;
+		uint8_t elapsed = now - ticks;
+		ticks = now;
 		
-		if (__console_bufferFirst == INPUT_BUFFER_SIZE) {
-			__console_bufferFirst = 0;
+		if (timeout) {
+			if (elapsed >= timeout) {
+				break;
+			}
+			
+			timeout -= elapsed;
 		}
+		
+		// Sleep until the next interrupt: a received character, or 
+		// the next millisecond tick at the latest, in case the 
+		// character arrived just before we got here.
+		PCON |= IDL;
+	}
+	
+	TR0 = 0;
+	
+	return result;
+}
+#endif // CONSOLE_IDLE_WAIT
+
+#ifdef CONSOLE_FLOW_CONTROL_RTS_CTS
+void __console_startSending(unsigned char next);
+
+/*
+ * CTS changes don't trigger any interrupt: this restarts transmission 
+ * when characters are waiting and the remote end became ready again. 
+ * Called from the input functions too, so output resumes even if the 
+ * application never writes or flushes again.
+ */
+inline void __console_restartOutput() {
+	if (!__console_sending && __console_outputFirst != __console_outputNext && __console_clearToSend()) {
+		__console_startSending(__console_outputNext);
+	}
+}
+#else
+#define __console_restartOutput()
+#endif // CONSOLE_FLOW_CONTROL_RTS_CTS
+
+uint8_t console_available() {
+	__console_restartOutput();
+	
+	return (__console_receivedNext() - __console_bufferFirst) & INPUT_BUFFER_MASK;
+}
+
+uint8_t console_tryReadCharacter(uint8_t *c) {
+	__console_restartOutput();
+	
+	unsigned char first = __console_bufferFirst;
+	
+	if (first == __console_receivedNext()) {
+		return 0;
+	}
+	
+	*c = __console_inputBuffer[first];
+	__console_releaseInput((first + 1) & INPUT_BUFFER_MASK);
+	
+	return 1;
+}
+
+unsigned char console_readCharacter() {
+	__console_restartOutput();
+	
+	unsigned char result = 0;
+	unsigned char first = __console_bufferFirst;
+	
+	if (first != __console_receivedNext()) {
+		result = __console_inputBuffer[first];
+		__console_releaseInput((first + 1) & INPUT_BUFFER_MASK);
 	}
 	
 	return result;
 }
 
+uint8_t console_read(uint8_t *buffer, uint8_t maxLength) {
+	__console_restartOutput();
+	
+	uint8_t count = 0;
+	uint8_t first = __console_bufferFirst;
+	// Snapshot of the index updated by the ISR.
+	uint8_t next = __console_receivedNext();
+	
+	while (first != next && count < maxLength) {
+		buffer[count++] = __console_inputBuffer[first];
+		first = (first + 1) & INPUT_BUFFER_MASK;
+	}
+	
+	__console_releaseInput(first);
+	
+	return count;
+}
+
+void __console_startSending(unsigned char next) {
+	__critical {
+		__console_outputNext = next;
+		
+#ifdef CONSOLE_STATISTICS
+		unsigned char count = (next - __console_outputFirst) & OUTPUT_BUFFER_MASK;
+		
+		if (count > __console_statistics.outputHighWater) {
+			__console_statistics.outputHighWater = count;
+		}
+#endif // CONSOLE_STATISTICS
+		
+		if (!__console_sending) {
+			// The UART is idle: (re-)start transmission, the ISR 
+			// will take care of the rest of the buffer.
+#ifdef CONSOLE_USE_DMA
+			enableExtendedSFR();
+			__console_dmaSend();
+			disableExtendedSFR();
+#else
+			__console_transmitNext();
+#endif // CONSOLE_USE_DMA
+		}
+	}
+}
+
+/*
+ * Called while waiting for room in the output buffer, or for the 
+ * output buffer to be empty.
+ */
+void __console_waitForOutput() {
+#ifdef CONSOLE_FLOW_CONTROL_RTS_CTS
+	__console_restartOutput();
+#else
+	__asm nop __endasm;
+#endif // CONSOLE_FLOW_CONTROL_RTS_CTS
+}
+
 void console_sendCharacter(unsigned char c) {
-	while (__console_sending) {
-		__asm nop __endasm;
+	unsigned char next = (__console_outputNext + 1) & OUTPUT_BUFFER_MASK;
+	
+	// Only wait if the output buffer is full.
+	while (next == __console_outputFirst) {
+		__console_waitForOutput();
 	}
 	
-	__console_sending = 1;
-    S2BUF = c;
+	__console_outputBuffer[__console_outputNext] = c;
+	__console_startSending(next);
+}
+
+void console_write(const uint8_t *buffer, uint8_t length) {
+	uint8_t next = __console_outputNext;
+	
+	while (length) {
+		// Take a single snapshot of the index updated by the ISR: 
+		// it can only move forward, so the free space we compute 
+		// here can only be underestimated.
+		uint8_t first = __console_outputFirst;
+		uint8_t count = (first - next - 1) & OUTPUT_BUFFER_MASK;
+		
+		if (count == 0) {
+			// Output buffer is full.
+			__console_waitForOutput();
+			continue;
+		}
+		
+		if (count > length) {
+			count = length;
+		}
+		
+		length -= count;
+		
+		for (; count; count--) {
+			__console_outputBuffer[next] = *buffer++;
+			next = (next + 1) & OUTPUT_BUFFER_MASK;
+		}
+		
+		__console_startSending(next);
+	}
+}
+
+#ifdef CONSOLE_STATISTICS
+void console_getStatistics(ConsoleStatistics *statistics) {
+	__critical {
+		memcpy(statistics, &__console_statistics, sizeof(ConsoleStatistics));
+	}
+}
+#endif // CONSOLE_STATISTICS
+
+#ifdef CONSOLE_MULTIPROCESSOR_ADDRESS
+void console_sendAddress(uint8_t address) {
+	// The address/data bit applies to every character sent, 
+	// so we send the address alone.
+	console_flush();
+	S2CON |= S2TB8;
+	console_sendCharacter(address);
+	console_flush();
+	S2CON &= ~S2TB8;
+}
+#endif // CONSOLE_MULTIPROCESSOR_ADDRESS
+
+void console_flush() {
+	while (__console_sending || __console_outputFirst != __console_outputNext) {
+		__console_waitForOutput();
+	}
 }
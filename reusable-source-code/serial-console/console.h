@@ -30,6 +30,8 @@
 #ifndef _CONSOLE_H
 #define _CONSOLE_H
 
+#include <stdint.h>
+
 /**
  * @file console.h
  * 
@@ -64,29 +66,155 @@
  * 
  */
 
+/**
+ * Console driver statistics, only maintained when CONSOLE_STATISTICS 
+ * is defined. Counters wrap around.
+ */
+typedef struct {
+	/** Number of characters received by the UART. */
+	uint16_t bytesIn;
+	/** Number of characters sent by the UART. */
+	uint16_t bytesOut;
+	/**
+	 * Number of characters dropped because the input buffer was full 
+	 * (in DMA mode, number of times characters were dropped).
+	 */
+	uint16_t inputOverruns;
+	/** Number of characters received with an invalid stop bit (not counted in DMA mode). */
+	uint16_t framingErrors;
+	/** Highest number of characters seen in the input buffer. */
+	uint8_t inputHighWater;
+	/** Highest number of characters seen in the output buffer. */
+	uint8_t outputHighWater;
+} ConsoleStatistics;
+
 /**
  * Initialises the driver.
  * 
  * Configures the UART and initialises the driver's internal state.
  * 
+ * The baud rate is given by the CONSOLE_BAUD_RATE macro, and the 
+ * baud rate generator settings are worked out at compile time.
+ * 
  * Note: the console uses UART2, leaving UART1 for flash programming.
  */
-void console_initialise(unsigned long baudRate);
+void console_initialise();
 
 /**
  * Initiates the transmission of a character.
  * 
  * The character is placed in the output buffer, and transmission is 
- * (re-)started if needed.
+ * (re-)started if needed. The output buffer is drained by the UART 
+ * ISR, so this function returns immediately unless the buffer is full.
  */
 void console_sendCharacter(unsigned char c);
 
+/**
+ * Sends an address byte (9th bit set) to the nodes of a multiprocessor 
+ * bus, after waiting for all characters in the output buffer to be 
+ * sent. Returns once the address byte has been sent.
+ * 
+ * Only available when CONSOLE_MULTIPROCESSOR_ADDRESS is defined.
+ */
+void console_sendAddress(uint8_t address);
+
+/**
+ * Copies the driver statistics into the given structure.
+ * 
+ * Only available when CONSOLE_STATISTICS is defined.
+ */
+void console_getStatistics(ConsoleStatistics *statistics);
+
+/**
+ * Waits until the output buffer is empty and the last character 
+ * has been sent.
+ */
+void console_flush();
+
 /**
  * @returns the next character available in the input buffer, 
  * or 0 if the buffer was empty.
+ * 
+ * As a received 0 can't be told apart from an empty buffer, use 
+ * console_tryReadCharacter() for binary data.
  */
 unsigned char console_readCharacter();
 
+/**
+ * @returns the number of characters available in the input buffer.
+ */
+uint8_t console_available();
+
+/**
+ * Removes the next character from the input buffer, if any, and 
+ * stores it in c. Doesn't wait for characters to be received.
+ * 
+ * @returns 1 if a character was read, 0 if the buffer was empty.
+ */
+uint8_t console_tryReadCharacter(uint8_t *c);
+
+/**
+ * Waits for a character to be received, at most timeout milliseconds 
+ * (forever if timeout is 0), and stores it in c. The CPU is kept in 
+ * idle mode while waiting.
+ * 
+ * Only available when CONSOLE_IDLE_WAIT is defined.
+ * 
+ * @returns 1 if a character was read, 0 on timeout.
+ */
+uint8_t console_waitCharacter(uint8_t *c, uint16_t timeout);
+
+/**
+ * Places a block of characters in the output buffer, waiting for 
+ * room to become available if needed.
+ * 
+ * Unlike calling console_sendCharacter() in a loop, the output buffer 
+ * state is only read and updated once per contiguous block of free 
+ * space, which is significantly faster.
+ */
+void console_write(const uint8_t *buffer, uint8_t length);
+
+/**
+ * Copies at most maxLength characters from the input buffer into 
+ * the given buffer. Doesn't wait for characters to be received.
+ * 
+ * @returns the number of characters actually copied.
+ */
+uint8_t console_read(uint8_t *buffer, uint8_t maxLength);
+
+/**
+ * @returns the length of the oldest complete frame waiting in the 
+ * input buffer, or 0 if there is none.
+ * 
+ * Only available when CONSOLE_FRAME_TIMEOUT is defined.
+ */
+uint8_t console_frameLength();
+
+/**
+ * Copies the oldest complete frame waiting in the input buffer into 
+ * the given buffer, and removes it from the input buffer. Characters 
+ * beyond maxLength are discarded. Doesn't wait for a frame to be 
+ * received.
+ * 
+ * Only available when CONSOLE_FRAME_TIMEOUT is defined.
+ * 
+ * @returns the length of the frame, or 0 if there was none.
+ */
+uint8_t console_readFrame(uint8_t *buffer, uint8_t maxLength);
+
+#if defined(CONSOLE_FRAME_TIMEOUT) || defined(CONSOLE_IDLE_WAIT)
+void __console_timer0_isr() __interrupt TIMER0_INTERRUPT __using 1;
+#endif // CONSOLE_FRAME_TIMEOUT || CONSOLE_IDLE_WAIT
+
+#ifdef CONSOLE_USE_DMA
+#ifndef CONSOLE_DMA_INTERRUPT
+// Unused interrupt number the UART2 DMA vectors are redirected to.
+#define CONSOLE_DMA_INTERRUPT 13
+#endif // CONSOLE_DMA_INTERRUPT
+
+void __uart2_dma_isr() __interrupt CONSOLE_DMA_INTERRUPT __using 1;
+#else
 void __uart2_isr() __interrupt UART2_INTERRUPT __using 1;
+#endif // CONSOLE_USE_DMA
 
 #endif // _CONSOLE_H
@@ -0,0 +1,181 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "console.h"
+#include "telemetry.h"
+
+/**
+ * @file telemetry.c
+ * 
+ * Binary telemetry frames sent over the serial console: implementation.
+ * 
+ * The frame is seen as the concatenation of a header (the sequence 
+ * number, if any), the caller's buffer and a trailer (the CRC), which 
+ * is COBS-encoded without being copied anywhere but in the console's 
+ * output buffer.
+ */
+
+#ifdef TELEMETRY_SEQUENCE_NUMBER
+#define HEADER_LENGTH 1
+
+uint8_t __telemetry_sequenceNumber;
+#else
+#define HEADER_LENGTH 0
+#endif // TELEMETRY_SEQUENCE_NUMBER
+
+#define TRAILER_LENGTH 2
+
+// Longest run of non-zero bytes in a COBS block.
+#define COBS_MAX_RUN 254
+
+const uint8_t *__telemetry_data;
+uint8_t __telemetry_length;
+// CRC, low byte first.
+uint8_t __telemetry_trailer[TRAILER_LENGTH];
+
+/*
+ * CRC-16 (CCITT polynomial, reflected, i.e. CRC-16/MCRF4XX) update 
+ * without lookup table.
+ */
+uint16_t __telemetry_crc(uint16_t crc, uint8_t data) {
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+	
+	return (((uint16_t) data << 8) | (crc >> 8)) ^ (uint8_t) (data >> 4) ^ ((uint16_t) data << 3);
+}
+
+/*
+ * @returns the byte of the unencoded frame at the given position.
+ */
+uint8_t __telemetry_byte(uint8_t position) {
+#ifdef TELEMETRY_SEQUENCE_NUMBER
+	if (position < HEADER_LENGTH) {
+		return __telemetry_sequenceNumber;
+	}
+#endif // TELEMETRY_SEQUENCE_NUMBER
+	
+	position -= HEADER_LENGTH;
+	
+	if (position < __telemetry_length) {
+		return __telemetry_data[position];
+	}
+	
+	return __telemetry_trailer[position - __telemetry_length];
+}
+
+/*
+ * Sends count bytes of the unencoded frame, starting at the given 
+ * position. The part coming from the caller's buffer is passed to 
+ * console_write() as a single block.
+ */
+void __telemetry_emit(uint8_t position, uint8_t count) {
+	uint8_t payloadEnd = HEADER_LENGTH + __telemetry_length;
+	
+#ifdef TELEMETRY_SEQUENCE_NUMBER
+	while (count && (position < HEADER_LENGTH || position >= payloadEnd)) {
+#else
+	while (count && position >= payloadEnd) {
+#endif // TELEMETRY_SEQUENCE_NUMBER
+		console_sendCharacter(__telemetry_byte(position++));
+		count--;
+	}
+	
+	if (count) {
+		uint8_t blockLength = payloadEnd - position;
+		
+		if (blockLength > count) {
+			blockLength = count;
+		}
+		
+		console_write(&__telemetry_data[position - HEADER_LENGTH], blockLength);
+		position += blockLength;
+		count -= blockLength;
+	}
+	
+	while (count--) {
+		console_sendCharacter(__telemetry_byte(position++));
+	}
+}
+
+void telemetry_send(const uint8_t *data, uint8_t length) {
+	if (length > TELEMETRY_MAX_LENGTH) {
+		length = TELEMETRY_MAX_LENGTH;
+	}
+	
+	__telemetry_data = data;
+	__telemetry_length = length;
+	
+	uint8_t total = HEADER_LENGTH + length + TRAILER_LENGTH;
+	uint16_t crc = 0xFFFF;
+	
+#ifdef TELEMETRY_SEQUENCE_NUMBER
+	crc = __telemetry_crc(crc, __telemetry_sequenceNumber);
+#endif // TELEMETRY_SEQUENCE_NUMBER
+	
+	for (uint8_t i = 0; i < length; i++) {
+		crc = __telemetry_crc(crc, data[i]);
+	}
+	
+	__telemetry_trailer[0] = crc & 0xFF;
+	__telemetry_trailer[1] = crc >> 8;
+	
+	// COBS encoding: each block is made of the number of bytes up to 
+	// the next 0 (included), followed by the non-zero bytes. The last 
+	// block ends with the frame, and a 254 byte block has no 0.
+	uint8_t position = 0;
+	
+	while (1) {
+		uint8_t run = 0;
+		
+		while (position + run < total && run < COBS_MAX_RUN && __telemetry_byte(position + run)) {
+			run++;
+		}
+		
+		console_sendCharacter(run + 1);
+		__telemetry_emit(position, run);
+		position += run;
+		
+		if (position == total) {
+			break;
+		}
+		
+		if (run < COBS_MAX_RUN) {
+			// Skip the 0.
+			position++;
+		}
+	}
+	
+	// Frame delimiter
+	console_sendCharacter(0);
+	
+#ifdef TELEMETRY_SEQUENCE_NUMBER
+	__telemetry_sequenceNumber++;
+#endif // TELEMETRY_SEQUENCE_NUMBER
+}
@@ -0,0 +1,470 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "uart.h"
+
+/**
+ * @file uart.c
+ * 
+ * Multi-UART driver implementation.
+ */
+
+#if defined(_STC12_H) || defined(_STC90_H)
+#error "The multi-UART driver only supports STC15 and STC8A/F/G/H"
+#endif // _STC12_H || _STC90_H
+
+#if defined(UART1_TIMER) && UART1_TIMER != 1 && UART1_TIMER != 2
+#error "UART1_TIMER must be 1 or 2"
+#endif
+
+#if defined(UART2_TIMER) && UART2_TIMER != 2
+#error "UART2_TIMER must be 2"
+#endif
+
+#if defined(UART3_TIMER) && UART3_TIMER != 2 && UART3_TIMER != 3
+#error "UART3_TIMER must be 2 or 3"
+#endif
+
+#if defined(UART4_TIMER) && UART4_TIMER != 2 && UART4_TIMER != 4
+#error "UART4_TIMER must be 2 or 4"
+#endif
+
+/*
+ * State and buffers are only allocated for the UART actually used. 
+ * __UARTn_INSTANCE is the index of UARTn in the state and buffer 
+ * arrays, and __UART_COUNTn the number of UART enabled up to UARTn.
+ */
+#define __UART_UNUSED 0xff
+
+#ifdef UART1_TIMER
+#define __UART1_INSTANCE 0
+#define __UART_COUNT1 1
+#else
+#define __UART1_INSTANCE __UART_UNUSED
+#define __UART_COUNT1 0
+#endif // UART1_TIMER
+
+#ifdef UART2_TIMER
+#define __UART2_INSTANCE __UART_COUNT1
+#define __UART_COUNT2 (__UART_COUNT1 + 1)
+#else
+#define __UART2_INSTANCE __UART_UNUSED
+#define __UART_COUNT2 __UART_COUNT1
+#endif // UART2_TIMER
+
+#ifdef UART3_TIMER
+#define __UART3_INSTANCE __UART_COUNT2
+#define __UART_COUNT3 (__UART_COUNT2 + 1)
+#else
+#define __UART3_INSTANCE __UART_UNUSED
+#define __UART_COUNT3 __UART_COUNT2
+#endif // UART3_TIMER
+
+#ifdef UART4_TIMER
+#define __UART4_INSTANCE __UART_COUNT3
+#define __UART_COUNT4 (__UART_COUNT3 + 1)
+#else
+#define __UART4_INSTANCE __UART_UNUSED
+#define __UART_COUNT4 __UART_COUNT3
+#endif // UART4_TIMER
+
+#define UART_INSTANCE_COUNT __UART_COUNT4
+
+#if UART_INSTANCE_COUNT == 0
+#error "No UART enabled: define at least one UARTn_TIMER macro in project-defs.h"
+#endif
+
+#ifndef UART_OUTPUT_BUFFER_SIZE
+#define UART_OUTPUT_BUFFER_SIZE 16
+#endif
+
+#ifndef UART_INPUT_BUFFER_SIZE
+#define UART_INPUT_BUFFER_SIZE 16
+#endif
+
+#ifndef UART_BUFFER_SPACE
+#define UART_BUFFER_SPACE
+#endif
+
+#if UART_OUTPUT_BUFFER_SIZE < 2 || UART_OUTPUT_BUFFER_SIZE > 256 || (UART_OUTPUT_BUFFER_SIZE & (UART_OUTPUT_BUFFER_SIZE - 1))
+#error "UART_OUTPUT_BUFFER_SIZE must be a power of 2 between 2 and 256"
+#endif
+
+#if UART_INPUT_BUFFER_SIZE < 2 || UART_INPUT_BUFFER_SIZE > 256 || (UART_INPUT_BUFFER_SIZE & (UART_INPUT_BUFFER_SIZE - 1))
+#error "UART_INPUT_BUFFER_SIZE must be a power of 2 between 2 and 256"
+#endif
+
+// Buffer sizes are powers of 2, so indexes wrap by simple masking.
+#define OUTPUT_BUFFER_MASK ((uint8_t) (UART_OUTPUT_BUFFER_SIZE - 1))
+#define INPUT_BUFFER_MASK ((uint8_t) (UART_INPUT_BUFFER_SIZE - 1))
+
+typedef struct {
+	volatile uint8_t outputFirst;
+	volatile uint8_t outputNext;
+	volatile uint8_t inputFirst;
+	volatile uint8_t inputNext;
+	volatile uint8_t sending;
+} UartState;
+
+UartState __uart_state[UART_INSTANCE_COUNT];
+UART_BUFFER_SPACE uint8_t __uart_outputBuffer[UART_INSTANCE_COUNT][UART_OUTPUT_BUFFER_SIZE];
+UART_BUFFER_SPACE uint8_t __uart_inputBuffer[UART_INSTANCE_COUNT][UART_INPUT_BUFFER_SIZE];
+
+__code uint8_t __uart_instance[] = {
+	__UART1_INSTANCE,
+	__UART2_INSTANCE,
+	__UART3_INSTANCE,
+	__UART4_INSTANCE,
+};
+
+/*
+ * ISR are identical except for the SFR they use. Since the instance 
+ * index is a constant, all state and buffer accesses are made at 
+ * fixed addresses.
+ */
+
+#ifdef UART1_TIMER
+void __uart1_isr() __interrupt UART1_INTERRUPT __using 1 __critical {
+	if (TI) {
+		TI = 0;
+		
+		if (__uart_state[__UART1_INSTANCE].outputFirst != __uart_state[__UART1_INSTANCE].outputNext) {
+			SBUF = __uart_outputBuffer[__UART1_INSTANCE][__uart_state[__UART1_INSTANCE].outputFirst];
+			__uart_state[__UART1_INSTANCE].outputFirst = (__uart_state[__UART1_INSTANCE].outputFirst + 1) & OUTPUT_BUFFER_MASK;
+		} else {
+			__uart_state[__UART1_INSTANCE].sending = 0;
+		}
+	}
+	
+	if (RI) {
+		RI = 0;
+		uint8_t next = (__uart_state[__UART1_INSTANCE].inputNext + 1) & INPUT_BUFFER_MASK;
+		
+		if (next != __uart_state[__UART1_INSTANCE].inputFirst) {
+			__uart_inputBuffer[__UART1_INSTANCE][__uart_state[__UART1_INSTANCE].inputNext] = SBUF;
+			__uart_state[__UART1_INSTANCE].inputNext = next;
+		}
+	}
+}
+#endif // UART1_TIMER
+
+#ifdef UART2_TIMER
+void __uart2_isr() __interrupt UART2_INTERRUPT __using 1 __critical {
+	if (S2CON & S2TI) {
+		S2CON &= ~S2TI;
+		
+		if (__uart_state[__UART2_INSTANCE].outputFirst != __uart_state[__UART2_INSTANCE].outputNext) {
+			S2BUF = __uart_outputBuffer[__UART2_INSTANCE][__uart_state[__UART2_INSTANCE].outputFirst];
+			__uart_state[__UART2_INSTANCE].outputFirst = (__uart_state[__UART2_INSTANCE].outputFirst + 1) & OUTPUT_BUFFER_MASK;
+		} else {
+			__uart_state[__UART2_INSTANCE].sending = 0;
+		}
+	}
+	
+	if (S2CON & S2RI) {
+		S2CON &= ~S2RI;
+		uint8_t next = (__uart_state[__UART2_INSTANCE].inputNext + 1) & INPUT_BUFFER_MASK;
+		
+		if (next != __uart_state[__UART2_INSTANCE].inputFirst) {
+			__uart_inputBuffer[__UART2_INSTANCE][__uart_state[__UART2_INSTANCE].inputNext] = S2BUF;
+			__uart_state[__UART2_INSTANCE].inputNext = next;
+		}
+	}
+}
+#endif // UART2_TIMER
+
+#ifdef UART3_TIMER
+void __uart3_isr() __interrupt UART3_INTERRUPT __using 1 __critical {
+	if (S3CON & S3TI) {
+		S3CON &= ~S3TI;
+		
+		if (__uart_state[__UART3_INSTANCE].outputFirst != __uart_state[__UART3_INSTANCE].outputNext) {
+			S3BUF = __uart_outputBuffer[__UART3_INSTANCE][__uart_state[__UART3_INSTANCE].outputFirst];
+			__uart_state[__UART3_INSTANCE].outputFirst = (__uart_state[__UART3_INSTANCE].outputFirst + 1) & OUTPUT_BUFFER_MASK;
+		} else {
+			__uart_state[__UART3_INSTANCE].sending = 0;
+		}
+	}
+	
+	if (S3CON & S3RI) {
+		S3CON &= ~S3RI;
+		uint8_t next = (__uart_state[__UART3_INSTANCE].inputNext + 1) & INPUT_BUFFER_MASK;
+		
+		if (next != __uart_state[__UART3_INSTANCE].inputFirst) {
+			__uart_inputBuffer[__UART3_INSTANCE][__uart_state[__UART3_INSTANCE].inputNext] = S3BUF;
+			__uart_state[__UART3_INSTANCE].inputNext = next;
+		}
+	}
+}
+#endif // UART3_TIMER
+
+#ifdef UART4_TIMER
+void __uart4_isr() __interrupt UART4_INTERRUPT __using 1 __critical {
+	if (S4CON & S4TI) {
+		S4CON &= ~S4TI;
+		
+		if (__uart_state[__UART4_INSTANCE].outputFirst != __uart_state[__UART4_INSTANCE].outputNext) {
+			S4BUF = __uart_outputBuffer[__UART4_INSTANCE][__uart_state[__UART4_INSTANCE].outputFirst];
+			__uart_state[__UART4_INSTANCE].outputFirst = (__uart_state[__UART4_INSTANCE].outputFirst + 1) & OUTPUT_BUFFER_MASK;
+		} else {
+			__uart_state[__UART4_INSTANCE].sending = 0;
+		}
+	}
+	
+	if (S4CON & S4RI) {
+		S4CON &= ~S4RI;
+		uint8_t next = (__uart_state[__UART4_INSTANCE].inputNext + 1) & INPUT_BUFFER_MASK;
+		
+		if (next != __uart_state[__UART4_INSTANCE].inputFirst) {
+			__uart_inputBuffer[__UART4_INSTANCE][__uart_state[__UART4_INSTANCE].inputNext] = S4BUF;
+			__uart_state[__UART4_INSTANCE].inputNext = next;
+		}
+	}
+}
+#endif // UART4_TIMER
+
+/*
+ * Baud rate generators run in 16-bit auto-reload mode, see 
+ * UART_RELOAD_VALUE().
+ */
+#if UART1_TIMER == 1
+inline void __uart_startTimer1(uint16_t reloadValue) {
+	TR1 = 0;
+	TMOD &= 0x0f;
+	TL1 = reloadValue & 0xff;
+	TH1 = reloadValue >> 8;
+	AUXR |= T1x12;
+	TR1 = 1;
+}
+#endif // UART1_TIMER == 1
+
+inline void __uart_startTimer2(uint16_t reloadValue) {
+	AUXR &= ~(T2R | T2_C_T);
+	T2L = reloadValue & 0xff;
+	T2H = reloadValue >> 8;
+	AUXR |= T2x12 | T2R;
+}
+
+#if UART3_TIMER == 3
+inline void __uart_startTimer3(uint16_t reloadValue) {
+	T4T3M &= 0xf0;
+	T3L = reloadValue & 0xff;
+	T3H = reloadValue >> 8;
+	T4T3M |= T3x12 | T3R;
+}
+#endif // UART3_TIMER == 3
+
+#if UART4_TIMER == 4
+inline void __uart_startTimer4(uint16_t reloadValue) {
+	T4T3M &= 0x0f;
+	T4L = reloadValue & 0xff;
+	T4H = reloadValue >> 8;
+	T4T3M |= T4x12 | T4R;
+}
+#endif // UART4_TIMER == 4
+
+void uart_initialise(UartPort port, uint16_t reloadValue) {
+	uint8_t instance = __uart_instance[port];
+	
+	if (instance == __UART_UNUSED) {
+		return;
+	}
+	
+	__uart_state[instance].outputFirst = 0;
+	__uart_state[instance].outputNext = 0;
+	__uart_state[instance].inputFirst = 0;
+	__uart_state[instance].inputNext = 0;
+	__uart_state[instance].sending = 0;
+	
+	switch (port) {
+#ifdef UART1_TIMER
+	case UART_PORT1:
+#if UART1_TIMER == 1
+		__uart_startTimer1(reloadValue);
+		AUXR &= ~S1ST2;
+#else
+		__uart_startTimer2(reloadValue);
+		AUXR |= S1ST2;
+#endif // UART1_TIMER == 1
+		// Mode 1 (8-bit, variable baud rate), reception enabled
+		SCON = 0x50;
+		ES = 1;
+		break;
+#endif // UART1_TIMER
+
+#ifdef UART2_TIMER
+	case UART_PORT2:
+		__uart_startTimer2(reloadValue);
+		// Mode 0 (8-bit, variable baud rate), reception enabled
+		S2CON = S2REN;
+		IE2 |= ES2;
+		break;
+#endif // UART2_TIMER
+
+#ifdef UART3_TIMER
+	case UART_PORT3:
+#if UART3_TIMER == 3
+		__uart_startTimer3(reloadValue);
+		S3CON = S3ST3 | S3REN;
+#else
+		__uart_startTimer2(reloadValue);
+		S3CON = S3REN;
+#endif // UART3_TIMER == 3
+		IE2 |= ES3;
+		break;
+#endif // UART3_TIMER
+
+#ifdef UART4_TIMER
+	case UART_PORT4:
+#if UART4_TIMER == 4
+		__uart_startTimer4(reloadValue);
+		S4CON = S4ST4 | S4REN;
+#else
+		__uart_startTimer2(reloadValue);
+		S4CON = S4REN;
+#endif // UART4_TIMER == 4
+		IE2 |= ES4;
+		break;
+#endif // UART4_TIMER
+	}
+}
+
+/*
+ * Writes a character to the transmit register of the UART.
+ */
+inline void __uart_transmit(UartPort port, uint8_t c) {
+	switch (port) {
+#ifdef UART1_TIMER
+	case UART_PORT1:
+		SBUF = c;
+		break;
+#endif // UART1_TIMER
+
+#ifdef UART2_TIMER
+	case UART_PORT2:
+		S2BUF = c;
+		break;
+#endif // UART2_TIMER
+
+#ifdef UART3_TIMER
+	case UART_PORT3:
+		S3BUF = c;
+		break;
+#endif // UART3_TIMER
+
+#ifdef UART4_TIMER
+	case UART_PORT4:
+		S4BUF = c;
+		break;
+#endif // UART4_TIMER
+	}
+}
+
+uint8_t uart_write(UartPort port, const uint8_t *buffer, uint8_t length) {
+	uint8_t instance = __uart_instance[port];
+	
+	if (instance == __UART_UNUSED) {
+		return 0;
+	}
+	
+	uint8_t next = __uart_state[instance].outputNext;
+	// Single snapshot of the index updated by the ISR.
+	uint8_t count = (__uart_state[instance].outputFirst - next - 1) & OUTPUT_BUFFER_MASK;
+	
+	if (count > length) {
+		count = length;
+	}
+	
+	if (count) {
+		for (uint8_t n = count; n; n--) {
+			__uart_outputBuffer[instance][next] = *buffer++;
+			next = (next + 1) & OUTPUT_BUFFER_MASK;
+		}
+		
+		__critical {
+			__uart_state[instance].outputNext = next;
+			
+			if (!__uart_state[instance].sending) {
+				// The UART is idle: (re-)start transmission, the ISR 
+				// will take care of the rest of the buffer.
+				uint8_t first = __uart_state[instance].outputFirst;
+				__uart_state[instance].sending = 1;
+				__uart_state[instance].outputFirst = (first + 1) & OUTPUT_BUFFER_MASK;
+				__uart_transmit(port, __uart_outputBuffer[instance][first]);
+			}
+		}
+	}
+	
+	return count;
+}
+
+uint8_t uart_read(UartPort port, uint8_t *buffer, uint8_t maxLength) {
+	uint8_t instance = __uart_instance[port];
+	
+	if (instance == __UART_UNUSED) {
+		return 0;
+	}
+	
+	uint8_t count = 0;
+	uint8_t first = __uart_state[instance].inputFirst;
+	// Snapshot of the index updated by the ISR.
+	uint8_t next = __uart_state[instance].inputNext;
+	
+	while (first != next && count < maxLength) {
+		buffer[count++] = __uart_inputBuffer[instance][first];
+		first = (first + 1) & INPUT_BUFFER_MASK;
+	}
+	
+	__uart_state[instance].inputFirst = first;
+	
+	return count;
+}
+
+uint8_t uart_available(UartPort port) {
+	uint8_t instance = __uart_instance[port];
+	
+	if (instance == __UART_UNUSED) {
+		return 0;
+	}
+	
+	return (__uart_state[instance].inputNext - __uart_state[instance].inputFirst) & INPUT_BUFFER_MASK;
+}
+
+void uart_flush(UartPort port) {
+	uint8_t instance = __uart_instance[port];
+	
+	if (instance == __UART_UNUSED) {
+		return;
+	}
+	
+	while (__uart_state[instance].sending) {
+		__asm nop __endasm;
+	}
+}
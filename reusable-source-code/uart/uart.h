@@ -0,0 +1,139 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _UART_H
+#define _UART_H
+
+#include <stdint.h>
+
+/**
+ * @file uart.h
+ * 
+ * Multi-UART driver: definitions.
+ * 
+ * Supported MCU families: STC15, STC8A/F/G/H.
+ * 
+ * Each UART has its own input and output buffers, and its own ISR. 
+ * Only the UART you enable in project-defs.h are compiled in, by 
+ * defining a UARTn_TIMER macro for each of them, whose value selects 
+ * the timer used as baud rate generator:
+ * 
+ * UART1_TIMER: 1 or 2
+ * UART2_TIMER: 2
+ * UART3_TIMER: 2 or 3
+ * UART4_TIMER: 2 or 4
+ * 
+ * e.g. #define UART3_TIMER 3
+ * 
+ * All UART using Timer 2 share the same baud rate.
+ * 
+ * Pin assignments are the default ones (see your MCU's datasheet). 
+ * Use P_SW1 and P_SW2 after calling uart_initialise() to change them.
+ * 
+ * **IMPORTANT:** In order to satisfy SDCC's requirements for ISR 
+ * handling, this header file **MUST** be included in the C source 
+ * file where main() is defined.
+ * 
+ * **IMPORTANT:** The serial console also uses UART2, so don't define 
+ * UART2_TIMER if your project uses it.
+ */
+
+typedef enum {
+	UART_PORT1 = 0,
+	UART_PORT2,
+	UART_PORT3,
+	UART_PORT4,
+} UartPort;
+
+/**
+ * Reload value of the baud rate generator for a given baud rate. 
+ * Baud rate generators are clocked at SYSclk/1 and, in mode 1, the 
+ * baud rate is a fourth of the timer overflow rate.
+ * 
+ * Use it with a constant so the division is done at compile time.
+ */
+#define UART_RELOAD_VALUE(baudRate) ((uint16_t) (65536UL - ((F_CPU / 4UL) + ((baudRate) / 2UL)) / (baudRate)))
+
+/**
+ * Configures the UART and its baud rate generator, and initialises 
+ * its buffers, e.g.
+ * 
+ * uart_initialise(UART_PORT3, UART_RELOAD_VALUE(115200UL));
+ * 
+ * Does nothing if the UART isn't enabled in project-defs.h.
+ */
+void uart_initialise(UartPort port, uint16_t reloadValue);
+
+/**
+ * Places as many characters as possible in the output buffer, and 
+ * (re-)starts transmission if needed. Never waits.
+ * 
+ * @returns the number of characters actually placed in the buffer.
+ */
+uint8_t uart_write(UartPort port, const uint8_t *buffer, uint8_t length);
+
+/**
+ * Copies at most maxLength characters from the input buffer into 
+ * the given buffer. Never waits.
+ * 
+ * @returns the number of characters actually copied.
+ */
+uint8_t uart_read(UartPort port, uint8_t *buffer, uint8_t maxLength);
+
+/**
+ * @returns the number of characters waiting in the input buffer.
+ */
+uint8_t uart_available(UartPort port);
+
+/**
+ * Waits until the output buffer is empty and the last character 
+ * has been sent.
+ * 
+ * Like uart_write(), uart_read() and uart_available(), does nothing 
+ * for a UART which isn't enabled in project-defs.h.
+ */
+void uart_flush(UartPort port);
+
+#ifdef UART1_TIMER
+void __uart1_isr() __interrupt UART1_INTERRUPT __using 1;
+#endif // UART1_TIMER
+
+#ifdef UART2_TIMER
+void __uart2_isr() __interrupt UART2_INTERRUPT __using 1;
+#endif // UART2_TIMER
+
+#ifdef UART3_TIMER
+void __uart3_isr() __interrupt UART3_INTERRUPT __using 1;
+#endif // UART3_TIMER
+
+#ifdef UART4_TIMER
+void __uart4_isr() __interrupt UART4_INTERRUPT __using 1;
+#endif // UART4_TIMER
+
+#endif // _UART_H
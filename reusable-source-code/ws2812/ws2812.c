@@ -0,0 +1,263 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "project-defs.h"
+#include "ws2812.h"
+
+/**
+ * @file ws2812.c
+ * 
+ * WS2812 (and compatible) addressable LED driver: implementation.
+ */
+
+#if !defined(_STC8AF_H) && !defined(_STC8G_H) && !defined(_STC8H_H)
+#error "Only the STC8 families are supported"
+#endif
+
+#ifndef WS2812_PIN
+#error "WS2812_PIN must be defined in project-defs.h"
+#endif
+
+/*
+ * Each bit starts with a rising edge. "mov pin, c" then takes the line 
+ * low after T0H for a 0, or leaves it high for a 1, and "clr pin" takes 
+ * it low after T1H in any case. All instructions involved (setb, clr, 
+ * mov bit/c, rlc, nop) take 1 clock cycle on the STC8 core, so:
+ * 
+ * T0H = T0H_NOPS + 1 cycles
+ * T1H = T0H + T1H_NOPS + 1 cycles
+ * bit period = T1H + LOW_NOPS + 2 cycles
+ * 
+ * Targets are T0H = 0.375 us, T1H = 0.75 us and a 1.25 us bit period. 
+ * Between bytes and LEDs, the line stays low a few more cycles for 
+ * the loop overhead (djnz, ljmp hop, next byte fetch), which the LEDs 
+ * tolerate.
+ * 
+ * When changing this code, check in the .rst listing that the generated 
+ * instructions between each setb/clr pair match the counts above.
+ */
+#if F_CPU == 22118400UL
+// T0H = 8 cycles (362 ns), T1H = 17 (769 ns), period = 28 (1.266 us)
+#define __WS2812_T0H_NOPS 7
+#define __WS2812_T1H_NOPS 8
+#define __WS2812_LOW_NOPS 9
+#elif F_CPU == 24000000UL
+// T0H = 9 cycles (375 ns), T1H = 18 (750 ns), period = 30 (1.250 us)
+#define __WS2812_T0H_NOPS 8
+#define __WS2812_T1H_NOPS 8
+#define __WS2812_LOW_NOPS 10
+#elif F_CPU == 27000000UL
+// T0H = 10 cycles (370 ns), T1H = 20 (741 ns), period = 34 (1.259 us)
+#define __WS2812_T0H_NOPS 9
+#define __WS2812_T1H_NOPS 9
+#define __WS2812_LOW_NOPS 12
+#elif F_CPU == 35000000UL
+// T0H = 13 cycles (371 ns), T1H = 27 (771 ns), period = 44 (1.257 us)
+#define __WS2812_T0H_NOPS 12
+#define __WS2812_T1H_NOPS 13
+#define __WS2812_LOW_NOPS 15
+#else
+#error "Unsupported F_CPU: use 22118400UL, 24000000UL, 27000000UL or 35000000UL"
+#endif // F_CPU
+
+// Assembler name of the sbit WS2812_PIN refers to.
+#define __WS2812_ASM_NAME(pin) _ ## pin
+#define __WS2812_ASM_SYMBOL(pin) __WS2812_ASM_NAME(pin)
+#define __WS2812_PIN __WS2812_ASM_SYMBOL(WS2812_PIN)
+
+// Read with direct addressing by __ws2812_stream(): they must stay in 
+// __data whatever the memory model.
+const uint8_t __xdata * __data __ws2812_data;
+__data uint16_t __ws2812_count;
+
+void __ws2812_stream() __naked {
+	__asm
+		mov dpl, ___ws2812_data
+		mov dph, (___ws2812_data + 1)
+		mov r6, ___ws2812_count
+		mov r7, (___ws2812_count + 1)
+		
+		; Nothing to send?
+		mov a, r6
+		orl a, r7
+		jnz 00001$
+		ret
+00001$:
+		
+		; Turn the LED count into 2 nested djnz loop counts.
+		mov a, r6
+		jz 00005$
+		inc r7
+00005$:
+		; Keep EA (bit 7 of IE) to restore it after each LED.
+		mov r4, _IE
+00010$:
+		; Next LED
+		mov r5, #3
+		clr _EA
+00020$:
+		; Next byte, its most significant bit going to C
+		movx a, @dptr
+		inc dptr
+		rlc a
+		; Bit 7
+		setb __WS2812_PIN
+		.rept __WS2812_T0H_NOPS
+		nop
+		.endm
+		mov __WS2812_PIN, c
+		.rept __WS2812_T1H_NOPS
+		nop
+		.endm
+		clr __WS2812_PIN
+		rlc a
+		.rept __WS2812_LOW_NOPS
+		nop
+		.endm
+		; Bit 6
+		setb __WS2812_PIN
+		.rept __WS2812_T0H_NOPS
+		nop
+		.endm
+		mov __WS2812_PIN, c
+		.rept __WS2812_T1H_NOPS
+		nop
+		.endm
+		clr __WS2812_PIN
+		rlc a
+		.rept __WS2812_LOW_NOPS
+		nop
+		.endm
+		; Bit 5
+		setb __WS2812_PIN
+		.rept __WS2812_T0H_NOPS
+		nop
+		.endm
+		mov __WS2812_PIN, c
+		.rept __WS2812_T1H_NOPS
+		nop
+		.endm
+		clr __WS2812_PIN
+		rlc a
+		.rept __WS2812_LOW_NOPS
+		nop
+		.endm
+		; Bit 4
+		setb __WS2812_PIN
+		.rept __WS2812_T0H_NOPS
+		nop
+		.endm
+		mov __WS2812_PIN, c
+		.rept __WS2812_T1H_NOPS
+		nop
+		.endm
+		clr __WS2812_PIN
+		rlc a
+		.rept __WS2812_LOW_NOPS
+		nop
+		.endm
+		; Bit 3
+		setb __WS2812_PIN
+		.rept __WS2812_T0H_NOPS
+		nop
+		.endm
+		mov __WS2812_PIN, c
+		.rept __WS2812_T1H_NOPS
+		nop
+		.endm
+		clr __WS2812_PIN
+		rlc a
+		.rept __WS2812_LOW_NOPS
+		nop
+		.endm
+		; Bit 2
+		setb __WS2812_PIN
+		.rept __WS2812_T0H_NOPS
+		nop
+		.endm
+		mov __WS2812_PIN, c
+		.rept __WS2812_T1H_NOPS
+		nop
+		.endm
+		clr __WS2812_PIN
+		rlc a
+		.rept __WS2812_LOW_NOPS
+		nop
+		.endm
+		; Bit 1
+		setb __WS2812_PIN
+		.rept __WS2812_T0H_NOPS
+		nop
+		.endm
+		mov __WS2812_PIN, c
+		.rept __WS2812_T1H_NOPS
+		nop
+		.endm
+		clr __WS2812_PIN
+		rlc a
+		.rept __WS2812_LOW_NOPS
+		nop
+		.endm
+		; Bit 0
+		setb __WS2812_PIN
+		.rept __WS2812_T0H_NOPS
+		nop
+		.endm
+		mov __WS2812_PIN, c
+		.rept __WS2812_T1H_NOPS
+		nop
+		.endm
+		clr __WS2812_PIN
+		rlc a
+		.rept __WS2812_LOW_NOPS
+		nop
+		.endm
+		; The unrolled byte is too long for a relative jump back to 
+		; its start: hop to an ljmp instead, while the line is low.
+		djnz r5, 00030$
+		sjmp 00040$
+00030$:
+		ljmp 00020$
+00040$:
+		mov a, r4
+		rlc a
+		mov _EA, c
+		djnz r6, 00050$
+		djnz r7, 00050$
+		ret
+00050$:
+		ljmp 00010$
+	__endasm;
+}
+
+void ws2812_write(const uint8_t __xdata *grb, uint16_t ledCount) {
+	__ws2812_data = grb;
+	__ws2812_count = ledCount;
+	__ws2812_stream();
+}
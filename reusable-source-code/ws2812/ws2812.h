@@ -0,0 +1,68 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ * 
+ * Copyright (c) 2022 Vincent DEFERT. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _WS2812_H
+#define _WS2812_H
+
+#include <stdint.h>
+
+/**
+ * @file ws2812.h
+ * 
+ * WS2812 (and compatible) addressable LED driver: definitions.
+ * 
+ * Bits are sent by hand-scheduled code, whose timing is selected at 
+ * compile time among the supported values of F_CPU: 22118400, 
+ * 24000000, 27000000 and 35000000.
+ * 
+ * Supported MCU families: STC8A, STC8F, STC8G, STC8H.
+ */
+
+/**
+ * Size in bytes of the buffer needed by a given number of LEDs: 
+ * 3 bytes per LED, in green, red, blue order.
+ */
+#define WS2812_BUFFER_SIZE(ledCount) ((ledCount) * 3)
+
+/**
+ * Sends the colours of ledCount LEDs to the strip connected to 
+ * WS2812_PIN.
+ * 
+ * Interrupts are disabled while each LED is sent (about 30 us), and 
+ * restored to their previous state in between: ISRs must be short 
+ * enough not to hold the line low for longer than the reset time of 
+ * the LEDs (50 us or more), or the remaining LEDs would be left 
+ * unchanged.
+ * 
+ * The new colours are latched once the line has stayed low for the 
+ * reset time after this function returns.
+ */
+void ws2812_write(const uint8_t __xdata *grb, uint16_t ledCount);
+
+#endif // _WS2812_H